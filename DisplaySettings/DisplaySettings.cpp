@@ -397,8 +397,9 @@ namespace WPEFramework {
             }
         }
 
-        const string DisplaySettings::Initialize(PluginHost::IShell* /* service */)
+        const string DisplaySettings::Initialize(PluginHost::IShell* service)
         {
+            Utils::setThunderService(service);
             InitializeIARM();
 
             if (IARM_BUS_PWRMGR_POWERSTATE_ON == getSystemPowerState())
@@ -441,6 +442,7 @@ namespace WPEFramework {
             }
 
             DeinitializeIARM();
+            Utils::setThunderService(nullptr);
             DisplaySettings::_instance = nullptr;
         }
 
@@ -3606,16 +3608,14 @@ namespace WPEFramework {
 
 
         // Thunder plugins communication
-        std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement>> DisplaySettings::getHdmiCecSinkPlugin()
+        std::shared_ptr<Utils::ThunderLink> DisplaySettings::getHdmiCecSinkPlugin()
         {
-            Core::SystemInfo::SetEnvironment(_T("THUNDER_ACCESS"), (_T("127.0.0.1:9998")));
-            return make_shared<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement>>("org.rdk.HdmiCecSink.1", "");
+            return Utils::getThunderLink("org.rdk.HdmiCecSink.1");
         }
 
-        std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement>> DisplaySettings::getSystemPlugin()
+        std::shared_ptr<Utils::ThunderLink> DisplaySettings::getSystemPlugin()
         {
-            Core::SystemInfo::SetEnvironment(_T("THUNDER_ACCESS"), (_T("127.0.0.1:9998")));
-            return make_shared<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement>>("org.rdk.System.1", "");
+            return Utils::getThunderLink("org.rdk.System.1");
         }
 
         IARM_Bus_PWRMgr_PowerState_t DisplaySettings::getSystemPowerState()
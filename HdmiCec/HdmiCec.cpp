@@ -110,6 +110,7 @@ namespace WPEFramework
             HdmiCec::_instance = nullptr;
 
             DeinitializeIARM();
+            Utils::flushJsonSettings();
 
         }
 
@@ -293,14 +294,8 @@ namespace WPEFramework
 
         bool HdmiCec::loadSettings()
         {
-            Core::File file;
-            file = CEC_SETTING_ENABLED_FILE;
-
-            file.Open();
             JsonObject parameters;
-            parameters.IElement::FromFile(file);
-
-            file.Close();
+            Utils::loadJsonSettings(CEC_SETTING_ENABLED_FILE, parameters);
 
             getBoolParameter(CEC_SETTING_ENABLED, cecSettingEnabled);
 
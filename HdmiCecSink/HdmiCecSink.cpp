@@ -592,6 +592,7 @@ namespace WPEFramework
        void HdmiCecSink::Deinitialize(PluginHost::IShell* /* service */)
        {
 	    CECDisable();
+            Utils::flushJsonSettings();
 	    m_currentArcRoutingState = ARC_STATE_ARC_EXIT;
 
             m_semSignaltoArcRoutingThread.release();
@@ -1377,13 +1378,9 @@ namespace WPEFramework
 	   }
         bool HdmiCecSink::loadSettings()
         {
-            Core::File file;
-            file = CEC_SETTING_ENABLED_FILE;
-
-            if( file.Open())
+            JsonObject parameters;
+            if (Utils::loadJsonSettings(CEC_SETTING_ENABLED_FILE, parameters))
             {
-                JsonObject parameters;
-                parameters.IElement::FromFile(file);
                 bool isConfigAdded = false;
 
                 if( parameters.HasLabel(CEC_SETTING_ENABLED))
@@ -1443,22 +1440,12 @@ namespace WPEFramework
                 if(isConfigAdded)
                 {
                     LOGINFO("isConfigAdded true so update file:\n ");
-                    file.Destroy();
-                    file.Create();
-                    parameters.IElement::ToFile(file);
-
+                    Utils::persistJsonSettings(CEC_SETTING_ENABLED_FILE, parameters);
                 }
-
-                file.Close();
             }
             else
             {
                 LOGINFO("CEC_SETTING_ENABLED_FILE file not present create with default settings ");
-                file.Open(false);
-                if (!file.IsOpen())
-                    file.Create();
-
-                JsonObject parameters;
                 unsigned int  vendorId = (defaultVendorId.at(0) <<16) | ( defaultVendorId.at(1) << 8 ) | defaultVendorId.at(2);
                 parameters[CEC_SETTING_ENABLED] = true;
                 parameters[CEC_SETTING_OSD_NAME] = osdName.toString();
@@ -1466,10 +1453,7 @@ namespace WPEFramework
 
                 cecSettingEnabled = true;
                 cecOTPSettingEnabled = true;
-                parameters.IElement::ToFile(file);
-
-                file.Close();
-
+                Utils::persistJsonSettings(CEC_SETTING_ENABLED_FILE, parameters);
             }
 
             return cecSettingEnabled;
@@ -444,6 +444,7 @@ namespace WPEFramework
            HdmiCec_2::_instance = nullptr;
            smConnection = NULL;
            DeinitializeIARM();
+           Utils::flushJsonSettings();
        }
 
        void HdmiCec_2::SendStandbyMsgEvent(const int logicalAddress)
@@ -811,13 +812,9 @@ namespace WPEFramework
 
         bool HdmiCec_2::loadSettings()
         {
-            Core::File file;
-            file = CEC_SETTING_ENABLED_FILE;
-
-            if( file.Open())
+            JsonObject parameters;
+            if (Utils::loadJsonSettings(CEC_SETTING_ENABLED_FILE, parameters))
             {
-                JsonObject parameters;
-                parameters.IElement::FromFile(file);
                 bool isConfigAdded = false;
 
                 if( parameters.HasLabel(CEC_SETTING_ENABLED))
@@ -877,22 +874,12 @@ namespace WPEFramework
                 if(isConfigAdded)
                 {
                     LOGINFO("isConfigAdded true so update file:\n ");
-                    file.Destroy();
-                    file.Create();
-                    parameters.IElement::ToFile(file);
-
+                    Utils::persistJsonSettings(CEC_SETTING_ENABLED_FILE, parameters);
                 }
-
-                file.Close();
             }
             else
             {
                 LOGINFO("CEC_SETTING_ENABLED_FILE file not present create with default settings ");
-                file.Open(false);
-                if (!file.IsOpen())
-                    file.Create();
-
-                JsonObject parameters;
                 unsigned int  vendorId = (defaultVendorId.at(0) <<16) | ( defaultVendorId.at(1) << 8 ) | defaultVendorId.at(2);
                 parameters[CEC_SETTING_ENABLED] = true;
                 parameters[CEC_SETTING_OTP_ENABLED] = true;
@@ -901,10 +888,7 @@ namespace WPEFramework
 
                 cecSettingEnabled = true;
                 cecOTPSettingEnabled = true;
-                parameters.IElement::ToFile(file);
-
-                file.Close();
-
+                Utils::persistJsonSettings(CEC_SETTING_ENABLED_FILE, parameters);
             }
 
             return cecSettingEnabled;
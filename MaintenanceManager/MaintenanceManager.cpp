@@ -153,7 +153,7 @@ namespace WPEFramework {
         /* Global time variable */
         MaintenanceManager* MaintenanceManager::_instance = nullptr;
 
-        cSettings MaintenanceManager::m_setting(MAINTENANCE_MGR_RECORD_FILE);
+        cSettings MaintenanceManager::m_setting(MAINTENANCE_MGR_RECORD_FILE, SETTINGS_WRITE_BEHIND_MS);
         //TODO  this need to moved to a seperate class and vector based.
 
         string task_names_foreground[]={
@@ -362,8 +362,9 @@ namespace WPEFramework {
             MaintenanceManager::_instance = nullptr;
         }
 
-        const string MaintenanceManager::Initialize(PluginHost::IShell*)
+        const string MaintenanceManager::Initialize(PluginHost::IShell* service)
         {
+            Utils::setThunderService(service);
 #if defined(USE_IARMBUS) || defined(USE_IARM_BUS)
             InitializeIARM();
 #endif /* defined(USE_IARMBUS) || defined(USE_IARM_BUS) */
@@ -373,9 +374,11 @@ namespace WPEFramework {
 
         void MaintenanceManager::Deinitialize(PluginHost::IShell*)
         {
+            m_setting.flush();
 #if defined(USE_IARMBUS) || defined(USE_IARM_BUS)
             DeinitializeIARM();
 #endif /* defined(USE_IARMBUS) || defined(USE_IARM_BUS) */
+            Utils::setThunderService(nullptr);
         }
 
 #if defined(USE_IARMBUS) || defined(USE_IARM_BUS)
@@ -18,6 +18,7 @@
 **/
 
 #include "Network.h"
+#include "processrunner.h"
 
 using namespace std;
 
@@ -34,9 +35,6 @@ namespace WPEFramework
             JsonObject pingResult;
             string interface = "";
             string gateway;
-            bool result = false;
-            string outputFile;
-            FILE *fp = NULL;
 
             pingResult["target"] = endPoint;
 
@@ -68,50 +66,53 @@ namespace WPEFramework
                 return pingResult;
             }
 
-            char cmd [1000] = {0x0};
+            // ping is spawned directly with an argv, the endpoint never goes through a shell
+            std::vector<std::string> argv;
             if (NetUtils::isIPV6(endPoint))
             {
-                snprintf(cmd, sizeof(cmd), "ping6 -I %s -c %d -W 5 '%s' 2>&1",
-                        interface.c_str(), packets, endPoint.c_str());
+                argv.push_back("ping6");
+                argv.push_back("-I");
+                argv.push_back(interface);
             }
             else
             {
-                snprintf(cmd, sizeof(cmd), "ping -c %d -W 5 '%s' 2>&1",
-                        packets, endPoint.c_str());
+                argv.push_back("ping");
             }
+            argv.push_back("-c");
+            argv.push_back(std::to_string(packets));
+            argv.push_back("-W");
+            argv.push_back("5");
+            argv.push_back(endPoint);
 
-            LOGWARN("ping command: %s", cmd);
+            LOGWARN("ping command: %s -c %d -W 5 %s", argv[0].c_str(), packets, endPoint.c_str());
 
-            // Run the command and dump the output to /tmp/pingoutput
-            if (NetUtils::execCmd(cmd, outputFile, &result, "pingoutput") < 0)
+            // every packet waits at most 5 seconds for its reply
+            Utils::ProcessRunner::Options options;
+            options.mergeStderr = true;
+            options.timeoutMs = (packets + 1) * 5 * 1000;
+            Utils::ProcessRunner::Result processResult = Utils::ProcessRunner::run(argv, options);
+
+            if (!processResult.started)
             {
-                LOGERR("%s: SERVICEMANAGER_FILE_ERROR: Can't open pipe for command '%s' for read mode: %s"
-                        , __FUNCTION__, cmd, strerror(errno));
+                LOGERR("%s: SERVICEMANAGER_FILE_ERROR: Can't run command '%s'", __FUNCTION__, argv[0].c_str());
 
                 pingResult["success"] = false;
                 pingResult["error"] = "Could not run command";
             }
-            else if (!result) // check the command return status
+            else if (processResult.exitCode != 0) // check the command return status
             {
                 pingResult["success"] = false;
                 pingResult["error"] = "Could not ping endpoint";
             }
-            else if ((fp = fopen(outputFile.c_str(), "r")) == NULL)
-            {
-                pingResult["success"] = false;
-                pingResult["error"] = "Could not read ping result";
-            }
             else
             {
                 pingResult["success"] = true;
                 pingResult["error"] = "";
 
-                char linearray[1000]={0x0};
-                while(fgets(linearray, sizeof(linearray), fp) != NULL)
+                std::istringstream output(processResult.output);
+                string line;
+                while (std::getline(output, line))
                 {
-                    // remove newline from linearray
-                    linearray[strcspn(linearray, "\n")] = '\0';
-                    string line(linearray);
                     LOGINFO("ping result: %s", line.c_str());
 
                     if( line.find( "packet" ) != string::npos )
@@ -185,10 +186,6 @@ namespace WPEFramework
                         pingResult["error"] = "Bad Address";
                     }
                 }
-                fclose(fp);
-
-                // clear up
-                remove(outputFile.c_str());
             }
 
             pingResult["guid"] = guid;
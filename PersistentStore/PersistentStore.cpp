@@ -3,6 +3,7 @@
 #include <sqlite3.h>
 #include <glib.h>
 #include <unistd.h>
+#include <algorithm>
 
 #if defined(USE_PLABELS)
 #include "pbnj_utils.hpp"
@@ -13,6 +14,7 @@
 #endif
 
 #define SQLITE *(sqlite3**)&mData
+#define STATEMENT(s) ((sqlite3_stmt*)mStatements[s])
 #define SQLITE_IS_ERROR_DBWRITE(rc) (rc == SQLITE_READONLY || rc == SQLITE_CORRUPT)
 
 const short WPEFramework::Plugin::PersistentStore::API_VERSION_NUMBER_MAJOR = 1;
@@ -26,11 +28,18 @@ const string WPEFramework::Plugin::PersistentStore::METHOD_GET_KEYS = "getKeys";
 const string WPEFramework::Plugin::PersistentStore::METHOD_GET_NAMESPACES = "getNamespaces";
 const string WPEFramework::Plugin::PersistentStore::METHOD_GET_STORAGE_SIZE = "getStorageSize";
 const string WPEFramework::Plugin::PersistentStore::METHOD_FLUSH_CACHE = "flushCache";
+const string WPEFramework::Plugin::PersistentStore::METHOD_SET_VALUES = "setValues";
+const string WPEFramework::Plugin::PersistentStore::METHOD_GET_VALUES = "getValues";
+const string WPEFramework::Plugin::PersistentStore::METHOD_DELETE_KEYS = "deleteKeys";
+const string WPEFramework::Plugin::PersistentStore::METHOD_GET_CACHE_STATS = "getCacheStats";
+const string WPEFramework::Plugin::PersistentStore::METHOD_GET_ENTRIES = "getEntries";
 const string WPEFramework::Plugin::PersistentStore::EVT_ON_STORAGE_EXCEEDED = "onStorageExceeded";
 const char* WPEFramework::Plugin::PersistentStore::STORE_NAME = "rdkservicestore";
 const char* WPEFramework::Plugin::PersistentStore::STORE_KEY = "xyzzy123";
 const int64_t WPEFramework::Plugin::PersistentStore::MAX_SIZE_BYTES = 1000000;
 const int64_t WPEFramework::Plugin::PersistentStore::MAX_VALUE_SIZE_BYTES = 1000;
+const uint32_t WPEFramework::Plugin::PersistentStore::DEFAULT_PAGE_SIZE = 100;
+const uint32_t WPEFramework::Plugin::PersistentStore::MAX_PAGE_SIZE = 1000;
 
 using namespace std;
 
@@ -61,6 +70,40 @@ namespace {
     {
         return g_file_test(f, G_FILE_TEST_EXISTS);
     }
+
+    // Rough heap footprint of a cache entry: the key is held by the map and the LRU list
+    uint64_t cacheEntrySize(const string& ns, const string& key, const string& value)
+    {
+        return 2 * (ns.size() + key.size()) + value.size() + 128;
+    }
+
+    // Smallest string greater than every string starting with prefix (binary collation).
+    // Returns false if there is none, i.e. the prefix is all 0xFF bytes.
+    bool prefixEnd(const string& prefix, string& end)
+    {
+        end = prefix;
+        while (!end.empty())
+        {
+            unsigned char last = end.back();
+            end.pop_back();
+            if (last != 0xFF)
+            {
+                end.push_back(last + 1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Same result as SQLite length() for TEXT: number of UTF-8 characters
+    int64_t textLength(const string& s)
+    {
+        int64_t length = 0;
+        for (auto it = s.begin(); it != s.end(); ++it)
+            if ((*it & 0xC0) != 0x80)
+                length++;
+        return length;
+    }
 }
 
 namespace WPEFramework {
@@ -71,8 +114,25 @@ namespace WPEFramework {
         PersistentStore::PersistentStore()
             : AbstractPlugin()
             , mData(nullptr)
+            , mStoreKey(nullptr)
             , mReading(0)
+            , mTotalSize(0)
+            , mWriteBehind(false)
+            , mFlushDelay(1000)
+            , mFlushThreshold(64)
+            , mSynchronous("normal")
+            , mPendingSize(0)
+            , mFlushStop(false)
+            , mCacheBudget(262144)
+            , mCacheSize(0)
+            , mCacheGeneration(0)
+            , mCacheHits(0)
+            , mCacheMisses(0)
+            , mCacheEvictions(0)
         {
+            for (int i = 0; i < STMT_COUNT; i++)
+                mStatements[i] = nullptr;
+
             registerMethod(METHOD_SET_VALUE, &PersistentStore::setValueWrapper, this);
             registerMethod(METHOD_GET_VALUE, &PersistentStore::getValueWrapper, this);
             registerMethod(METHOD_DELETE_KEY, &PersistentStore::deleteKeyWrapper, this);
@@ -81,19 +141,59 @@ namespace WPEFramework {
             registerMethod(METHOD_GET_NAMESPACES, &PersistentStore::getNamespacesWrapper, this);
             registerMethod(METHOD_GET_STORAGE_SIZE, &PersistentStore::getStorageSizeWrapper, this);
             registerMethod(METHOD_FLUSH_CACHE, &PersistentStore::flushCacheWrapper, this);
+            registerMethod(METHOD_SET_VALUES, &PersistentStore::setValuesWrapper, this);
+            registerMethod(METHOD_GET_VALUES, &PersistentStore::getValuesWrapper, this);
+            registerMethod(METHOD_DELETE_KEYS, &PersistentStore::deleteKeysWrapper, this);
+            registerMethod(METHOD_GET_CACHE_STATS, &PersistentStore::getCacheStatsWrapper, this);
+            registerMethod(METHOD_GET_ENTRIES, &PersistentStore::getEntriesWrapper, this);
         }
 
         PersistentStore::~PersistentStore()
         {
         }
 
-        const string PersistentStore::Initialize(PluginHost::IShell* /* service */)
+        const string PersistentStore::Initialize(PluginHost::IShell* service)
         {
-            return open() ? "" : "init failed";
+            Config config;
+            config.FromString(service->ConfigLine());
+
+            mWriteBehind = config.WriteBehind.Value();
+            mFlushDelay = config.FlushDelay.Value();
+            mFlushThreshold = config.FlushThreshold.Value();
+            mSynchronous = config.Synchronous.Value();
+            mCacheBudget = config.CacheSize.Value();
+
+            if (!open())
+                return "init failed";
+
+            if (mWriteBehind)
+            {
+                LOGINFO("write-behind: delay %u ms, threshold %u", mFlushDelay, mFlushThreshold);
+
+                mFlushStop = false;
+                mFlushThread = std::thread(&PersistentStore::flushLoop, this);
+            }
+
+            return "";
         }
 
         void PersistentStore::Deinitialize(PluginHost::IShell* /* service */)
         {
+            if (mFlushThread.joinable())
+            {
+                {
+                    lock_guard<mutex> lck(mLock);
+                    mFlushStop = true;
+                }
+                mFlushCondition.notify_all();
+                mFlushThread.join();
+            }
+
+            {
+                lock_guard<mutex> lck(mLock);
+                flushPending();
+            }
+
             term();
         }
 
@@ -220,13 +320,26 @@ namespace WPEFramework {
                     response["error"] = "params empty";
                 else
                 {
+                    // Without "limit" all the keys are returned, as before paging was added
+                    string prefix;
+                    string cursor;
+                    uint32_t limit;
+                    getDefaultStringParameter("prefix", prefix, "");
+                    getDefaultStringParameter("cursor", cursor, "");
+                    getDefaultNumberParameter("limit", limit, 0);
+                    if (limit > MAX_PAGE_SIZE)
+                        limit = MAX_PAGE_SIZE;
+
                     vector<string> keys;
-                    success = getKeys(ns, keys);
+                    string nextCursor;
+                    success = getKeys(ns, prefix, cursor, limit, keys, nextCursor);
                     if (success) {
                         JsonArray jsonKeys;
                         for (auto it = keys.begin(); it != keys.end(); ++it)
                             jsonKeys.Add(*it);
                         response["keys"] = jsonKeys;
+                        if (!nextCursor.empty())
+                            response["cursor"] = nextCursor;
                     }
                 }
             }
@@ -279,117 +392,221 @@ namespace WPEFramework {
             returnResponse(success);
         }
 
-        bool PersistentStore::setValue(const string& ns, const string& key, const string& value)
+        uint32_t PersistentStore::setValuesWrapper(const JsonObject& parameters, JsonObject& response)
         {
-            LOGINFO("%s %s %s", ns.c_str(), key.c_str(), value.c_str());
+            LOGINFOMETHOD();
 
             bool success = false;
+            vector<Entry> entries;
+            if (parseEntries(parameters, "values", true, entries, response))
+                success = setValues(entries);
 
-            lock_guard<mutex> lck(mLock);
-            while (mReading > 0);
+            returnResponse(success);
+        }
 
-            sqlite3* &db = SQLITE;
+        uint32_t PersistentStore::getValuesWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
 
-            int retry = 0;
-            int rc;
-            do
+            bool success = false;
+            vector<Entry> entries;
+            if (parseEntries(parameters, "keys", false, entries, response))
             {
-                if (!db)
-                    break;
-
-                sqlite3_stmt *stmt;
-                sqlite3_prepare_v2(db, "SELECT sum(s) FROM ("
-                                       " SELECT sum(length(key)+length(value)) s FROM item"
-                                       " UNION ALL"
-                                       " SELECT sum(length(name)) s FROM namespace"
-                                       ");", -1, &stmt, nullptr);
-
-                rc = sqlite3_step(stmt);
-                if (rc == SQLITE_ROW)
+                vector<bool> found;
+                success = getValues(entries, found);
+                if (success)
                 {
-                    int64_t size = sqlite3_column_int64(stmt, 0);
-                    if (size > MAX_SIZE_BYTES)
-                        LOGWARN("max size exceeded: %lld", size);
-                    else
-                        success = true;
+                    JsonArray jsonValues;
+                    for (size_t i = 0; i < entries.size(); i++)
+                    {
+                        if (!found[i])
+                            continue;
+
+                        JsonObject jsonValue;
+                        jsonValue["namespace"] = entries[i].ns;
+                        jsonValue["key"] = entries[i].key;
+                        jsonValue["value"] = entries[i].value;
+                        jsonValues.Add(jsonValue);
+                    }
+                    response["values"] = jsonValues;
                 }
-                else
-                    LOGERR("ERROR getting size: %s", sqlite3_errstr(rc));
+            }
 
-                sqlite3_finalize(stmt);
+            returnResponse(success);
+        }
 
-                if (success)
+        uint32_t PersistentStore::deleteKeysWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            bool success = false;
+            vector<Entry> entries;
+            if (parseEntries(parameters, "keys", false, entries, response))
+                success = deleteKeys(entries);
+
+            returnResponse(success);
+        }
+
+        uint32_t PersistentStore::getCacheStatsWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            {
+                lock_guard<mutex> lck(mCacheLock);
+                response["hits"] = mCacheHits;
+                response["misses"] = mCacheMisses;
+                response["evictions"] = mCacheEvictions;
+                response["entries"] = (uint64_t)mCache.size();
+                response["size"] = mCacheSize;
+                response["budget"] = mCacheBudget;
+            }
+
+            returnResponse(true);
+        }
+
+        uint32_t PersistentStore::getEntriesWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            bool success = false;
+            if (!parameters.HasLabel("namespace"))
+            {
+                response["error"] = "params missing";
+            }
+            else
+            {
+                string ns = parameters["namespace"].String();
+                if (ns.empty())
+                    response["error"] = "params empty";
+                else
                 {
-                    success = false;
+                    string prefix;
+                    string cursor;
+                    uint32_t limit;
+                    getDefaultStringParameter("prefix", prefix, "");
+                    getDefaultStringParameter("cursor", cursor, "");
+                    getDefaultNumberParameter("limit", limit, DEFAULT_PAGE_SIZE);
+                    if (limit == 0 || limit > MAX_PAGE_SIZE)
+                        limit = MAX_PAGE_SIZE;
+
+                    vector<Entry> entries;
+                    string nextCursor;
+                    success = getEntries(ns, prefix, cursor, limit, entries, nextCursor);
+                    if (success) {
+                        JsonArray jsonEntries;
+                        for (auto it = entries.begin(); it != entries.end(); ++it)
+                        {
+                            JsonObject jsonEntry;
+                            jsonEntry["key"] = it->key;
+                            jsonEntry["value"] = it->value;
+                            jsonEntries.Add(jsonEntry);
+                        }
+                        response["entries"] = jsonEntries;
+                        if (!nextCursor.empty())
+                            response["cursor"] = nextCursor;
+                    }
+                }
+            }
 
-                    sqlite3_stmt *stmt;
-                    sqlite3_prepare_v2(db, "INSERT OR IGNORE INTO namespace (name) values (?);", -1, &stmt, nullptr);
+            returnResponse(success);
+        }
 
-                    sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
+        bool PersistentStore::parseEntries(const JsonObject& parameters, const char* name, bool withValue, std::vector<Entry>& entries, JsonObject& response)
+        {
+            if (!parameters.HasLabel(name) || parameters[name].Content() != Core::JSON::Variant::type::ARRAY)
+            {
+                response["error"] = "params missing";
+                return false;
+            }
 
-                    rc = sqlite3_step(stmt);
-                    if (rc != SQLITE_DONE)
-                        LOGERR("ERROR inserting data: %s", sqlite3_errstr(rc));
-                    else
-                        success = true;
+            const JsonArray& array = parameters[name].Array();
+            if (array.Length() == 0)
+            {
+                response["error"] = "params empty";
+                return false;
+            }
 
-                    sqlite3_finalize(stmt);
+            entries.reserve(array.Length());
+            for (uint32_t i = 0; i < array.Length(); i++)
+            {
+                const JsonObject item = array[i].Object();
+                if (!item.HasLabel("namespace") ||
+                    !item.HasLabel("key") ||
+                    (withValue && !item.HasLabel("value")))
+                {
+                    response["error"] = "params missing";
+                    return false;
                 }
 
-                if (success)
+                Entry entry;
+                entry.ns = item["namespace"].String();
+                entry.key = item["key"].String();
+                if (withValue)
+                    entry.value = item["value"].String();
+
+                if (entry.ns.empty() || entry.key.empty())
                 {
-                    success = false;
+                    response["error"] = "params empty";
+                    return false;
+                }
+                if (entry.ns.size() > 1000 || entry.key.size() > 1000 || entry.value.size() > 1000)
+                {
+                    response["error"] = "params too long";
+                    return false;
+                }
 
-                    sqlite3_stmt *stmt;
-                    sqlite3_prepare_v2(db, "INSERT INTO item (ns,key,value)"
-                                           " SELECT id, ?, ?"
-                                           " FROM namespace"
-                                           " WHERE name = ?"
-                                           ";", -1, &stmt, nullptr);
+                entries.push_back(entry);
+            }
 
-                    sqlite3_bind_text(stmt, 1, key.c_str(), -1, SQLITE_TRANSIENT);
-                    sqlite3_bind_text(stmt, 2, value.c_str(), -1, SQLITE_TRANSIENT);
-                    sqlite3_bind_text(stmt, 3, ns.c_str(), -1, SQLITE_TRANSIENT);
+            return true;
+        }
 
-                    rc = sqlite3_step(stmt);
-                    if (rc != SQLITE_DONE)
-                        LOGERR("ERROR inserting data: %s", sqlite3_errstr(rc));
-                    else
-                        success = true;
+        bool PersistentStore::setValue(const string& ns, const string& key, const string& value)
+        {
+            LOGINFO("%s %s %s", ns.c_str(), key.c_str(), value.c_str());
 
-                    sqlite3_finalize(stmt);
-                }
-            } while (!success && SQLITE_IS_ERROR_DBWRITE(rc) && (++retry < 2) && open());
+            bool success = false;
 
-            if (success)
-            {
-                success = false;
+            lock_guard<mutex> lck(mLock);
 
-                sqlite3_stmt *stmt;
-                sqlite3_prepare_v2(db, "SELECT sum(s) FROM ("
-                                       " SELECT sum(length(key)+length(value)) s FROM item"
-                                       " UNION ALL"
-                                       " SELECT sum(length(name)) s FROM namespace"
-                                       ");", -1, &stmt, nullptr);
+            cacheErase(ns, key);
 
-                rc = sqlite3_step(stmt);
-                if (rc == SQLITE_ROW)
-                {
-                    int64_t size = sqlite3_column_int64(stmt, 0);
-                    if (size > MAX_SIZE_BYTES)
-                    {
-                        LOGWARN("max size exceeded: %lld", size);
+            sqlite3* &db = SQLITE;
 
-                        JsonObject params;
-                        sendNotify(C_STR(EVT_ON_STORAGE_EXCEEDED), params);
-                    }
-                    else
-                        success = true;
+            // Nothing queued could ever be written without an open DB
+            if (!db)
+                return false;
+
+            if (mWriteBehind)
+                return queueItem(ns, key, value);
+
+            while (mReading > 0);
+
+            int retry = 0;
+            int rc;
+            do
+            {
+                if (!db)
+                    break;
+
+                rc = SQLITE_OK;
+                if (mTotalSize > MAX_SIZE_BYTES)
+                    LOGWARN("max size exceeded: %lld", (long long)mTotalSize);
+                else if (beginTransaction(rc))
+                {
+                    success = insertItem(ns, key, value, rc);
+                    success = endTransaction(success, rc);
                 }
-                else
-                    LOGERR("ERROR getting size: %s", sqlite3_errstr(rc));
+            } while (!success && SQLITE_IS_ERROR_DBWRITE(rc) && (++retry < 2) && open());
 
-                sqlite3_finalize(stmt);
+            if (success && mTotalSize > MAX_SIZE_BYTES)
+            {
+                LOGWARN("max size exceeded: %lld", (long long)mTotalSize);
+
+                JsonObject params;
+                sendNotify(C_STR(EVT_ON_STORAGE_EXCEEDED), params);
+
+                success = false;
             }
 
             return success;
@@ -401,8 +618,15 @@ namespace WPEFramework {
 
             bool success = false;
 
+            if (cacheGet(ns, key, value))
+                return true;
+
+            uint64_t generation;
             {
                 lock_guard<mutex> lck(mLock);
+                if (findPending(ns, key, value))
+                    return true;
+                generation = cacheGeneration();
                 mReading++;
             }
 
@@ -410,27 +634,21 @@ namespace WPEFramework {
 
             if (db)
             {
-                sqlite3_stmt *stmt;
-                sqlite3_prepare_v2(db, "SELECT value"
-                                       " FROM item"
-                                       " INNER JOIN namespace ON namespace.id = item.ns"
-                                       " where name = ? and key = ?"
-                                       ";", -1, &stmt, nullptr);
+                void* stmt = acquireReadStatement(STMT_GET_VALUE);
 
-                sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
-                sqlite3_bind_text(stmt, 2, key.c_str(), -1, SQLITE_TRANSIENT);
-
-                int rc = sqlite3_step(stmt);
-                if (rc == SQLITE_ROW)
-                {
-                    value = (const char*)sqlite3_column_text(stmt, 0);
+                int rc;
+                if (selectItem(stmt, ns, key, value, rc) && rc == SQLITE_ROW)
                     success = true;
-                }
                 else
                     LOGWARN("not found: %d", rc);
-                sqlite3_finalize(stmt);
+
+                releaseReadStatement(STMT_GET_VALUE, stmt);
             }
 
+            // Before mReading drops, so a writer waiting on it invalidates after this
+            if (success)
+                cachePut(ns, key, value, generation);
+
             mReading--;
 
             return success;
@@ -444,6 +662,8 @@ namespace WPEFramework {
 
             lock_guard<mutex> lck(mLock);
             while (mReading > 0);
+            flushPending();
+            cacheErase(ns, key);
 
             sqlite3* &db = SQLITE;
 
@@ -454,22 +674,11 @@ namespace WPEFramework {
                 if (!db)
                     break;
 
-                sqlite3_stmt *stmt;
-                sqlite3_prepare_v2(db, "DELETE FROM item"
-                                       " where ns in (select id from namespace where name = ?)"
-                                       " and key = ?"
-                                       ";", -1, &stmt, NULL);
-
-                sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
-                sqlite3_bind_text(stmt, 2, key.c_str(), -1, SQLITE_TRANSIENT);
-
-                rc = sqlite3_step(stmt);
-                if (rc != SQLITE_DONE)
-                    LOGERR("ERROR removing data: %s", sqlite3_errstr(rc));
-                else
-                    success = true;
-
-                sqlite3_finalize(stmt);
+                if (beginTransaction(rc))
+                {
+                    success = removeItem(ns, key, rc);
+                    success = endTransaction(success, rc);
+                }
             } while (!success && SQLITE_IS_ERROR_DBWRITE(rc) && (++retry < 2) && open());
 
             return success;
@@ -483,6 +692,8 @@ namespace WPEFramework {
 
             lock_guard<mutex> lck(mLock);
             while (mReading > 0);
+            flushPending();
+            cacheEraseNamespace(ns);
 
             sqlite3* &db = SQLITE;
 
@@ -493,18 +704,11 @@ namespace WPEFramework {
                 if (!db)
                     break;
 
-                sqlite3_stmt *stmt;
-                sqlite3_prepare_v2(db, "DELETE FROM namespace where name = ?;", -1, &stmt, NULL);
-
-                sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
-
-                rc = sqlite3_step(stmt);
-                if (rc != SQLITE_DONE)
-                    LOGERR("ERROR removing data: %s", sqlite3_errstr(rc));
-                else
-                    success = true;
-
-                sqlite3_finalize(stmt);
+                if (beginTransaction(rc))
+                {
+                    success = removeNamespace(ns, rc);
+                    success = endTransaction(success, rc);
+                }
             } while (!success && SQLITE_IS_ERROR_DBWRITE(rc) && (++retry < 2) && open());
 
             return success;
@@ -512,47 +716,42 @@ namespace WPEFramework {
 
         bool PersistentStore::getKeys(const string& ns, std::vector<string>& keys)
         {
-            LOGINFO("%s", ns.c_str());
-
-            bool success = false;
-
-            {
-                lock_guard<mutex> lck(mLock);
-                mReading++;
-            }
+            string nextCursor;
+            return getKeys(ns, string(), string(), 0, keys, nextCursor);
+        }
 
-            sqlite3* &db = SQLITE;
+        bool PersistentStore::getKeys(const string& ns, const string& prefix, const string& cursor, uint32_t limit, std::vector<string>& keys, string& nextCursor)
+        {
+            LOGINFO("%s '%s' '%s' %u", ns.c_str(), prefix.c_str(), cursor.c_str(), limit);
 
             keys.clear();
 
-            if (db)
+            vector<Entry> entries;
+            bool success = listItems(ns, prefix, cursor, limit, false, entries, nextCursor);
+            if (success)
             {
-                sqlite3_stmt *stmt;
-                sqlite3_prepare_v2(db, "SELECT key"
-                                       " FROM item"
-                                       " where ns in (select id from namespace where name = ?)"
-                                       ";", -1, &stmt, NULL);
-
-                sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
-
-                while (sqlite3_step(stmt) == SQLITE_ROW)
-                    keys.push_back((const char*)sqlite3_column_text(stmt, 0));
-
-                sqlite3_finalize(stmt);
-                success = true;
+                keys.reserve(entries.size());
+                for (auto it = entries.begin(); it != entries.end(); ++it)
+                    keys.push_back(it->key);
             }
 
-            mReading--;
-
             return success;
         }
 
+        bool PersistentStore::getEntries(const string& ns, const string& prefix, const string& cursor, uint32_t limit, std::vector<Entry>& entries, string& nextCursor)
+        {
+            LOGINFO("%s '%s' '%s' %u", ns.c_str(), prefix.c_str(), cursor.c_str(), limit);
+
+            return listItems(ns, prefix, cursor, limit, true, entries, nextCursor);
+        }
+
         bool PersistentStore::getNamespaces(std::vector<string>& namespaces)
         {
             bool success = false;
 
             {
                 lock_guard<mutex> lck(mLock);
+                flushPending();
                 mReading++;
             }
 
@@ -581,10 +780,8 @@ namespace WPEFramework {
         {
             bool success = false;
 
-            {
-                lock_guard<mutex> lck(mLock);
-                mReading++;
-            }
+            lock_guard<mutex> lck(mLock);
+            flushPending();
 
             sqlite3* &db = SQLITE;
 
@@ -592,22 +789,14 @@ namespace WPEFramework {
 
             if (db)
             {
-                sqlite3_stmt *stmt;
-                sqlite3_prepare_v2(db, "SELECT name, sum(length(key)+length(value))"
-                                       " FROM item"
-                                       " INNER JOIN namespace ON namespace.id = item.ns"
-                                       " GROUP BY name"
-                                       ";", -1, &stmt, NULL);
-
-                while (sqlite3_step(stmt) == SQLITE_ROW)
-                    namespaceSizes[(const char*)sqlite3_column_text(stmt, 0)] = sqlite3_column_int(stmt, 1);
+                // Namespaces without items are left out, as with "GROUP BY name" over the items
+                for (auto it = mNamespaceSizes.begin(); it != mNamespaceSizes.end(); ++it)
+                    if (it->second > 0)
+                        namespaceSizes[it->first] = it->second;
 
-                sqlite3_finalize(stmt);
                 success = true;
             }
 
-            mReading--;
-
             return success;
         }
 
@@ -616,43 +805,210 @@ namespace WPEFramework {
             lock_guard<mutex> lck(mLock);
             while (mReading > 0);
 
+            // Explicit durability barrier: commit what is pending and checkpoint the WAL
+            bool success = flushPending();
+
             sqlite3* &db = SQLITE;
-            bool success = false;
 
             if (db)
             {
-                int rc = sqlite3_db_cacheflush(db);
-                success = (rc == SQLITE_OK);
+                int rc = sqlite3_wal_checkpoint_v2(db, nullptr, SQLITE_CHECKPOINT_TRUNCATE, nullptr, nullptr);
+                if (rc != SQLITE_OK)
+                {
+                    LOGERR("Error while checkpointing sqlite database: %d", rc);
+                    success = false;
+                }
+
+                rc = sqlite3_db_cacheflush(db);
                 if (rc != SQLITE_OK)
                 {
                     LOGERR("Error while flushing sqlite database cache: %d", rc);
+                    success = false;
                 }
             }
             sync();
             return success;
         }
 
-        bool PersistentStore::open()
+        bool PersistentStore::setValues(const std::vector<Entry>& entries)
         {
-            bool result;
+            LOGINFO("%zu entries", entries.size());
+
+            bool success = false;
+            bool exceeded = false;
 
-            auto path = g_build_filename("opt", "persistent", nullptr);
-            auto file = g_build_filename(path, STORE_NAME, nullptr);
+            lock_guard<mutex> lck(mLock);
+            while (mReading > 0);
+            flushPending();
+            for (auto it = entries.begin(); it != entries.end(); ++it)
+                cacheErase(it->ns, it->key);
 
             sqlite3* &db = SQLITE;
 
-            if (db && fileExists(file))
-                result = false; // Seems open!
-            else
+            int retry = 0;
+            int rc;
+            do
             {
-                if (!fileExists(path))
-                    g_mkdir_with_parents(path, 0745);
+                if (!db)
+                    break;
 
-                result = init(file, STORE_KEY);
+                rc = SQLITE_OK;
+                if (mTotalSize > MAX_SIZE_BYTES)
+                    LOGWARN("max size exceeded: %lld", (long long)mTotalSize);
+                else if (beginTransaction(rc))
+                {
+                    success = true;
+                    for (auto it = entries.begin(); success && it != entries.end(); ++it)
+                        success = insertItem(it->ns, it->key, it->value, rc);
+
+                    // The quota applies to the batch as a whole: all or nothing
+                    if (success && mTotalSize > MAX_SIZE_BYTES)
+                    {
+                        LOGWARN("max size exceeded: %lld", (long long)mTotalSize);
+                        exceeded = true;
+                        success = false;
+                    }
+
+                    success = endTransaction(success, rc);
+                }
+            } while (!success && !exceeded && SQLITE_IS_ERROR_DBWRITE(rc) && (++retry < 2) && open());
+
+            if (exceeded)
+            {
+                JsonObject params;
+                sendNotify(C_STR(EVT_ON_STORAGE_EXCEEDED), params);
+            }
+
+            return success;
+        }
+
+        bool PersistentStore::getValues(std::vector<Entry>& entries, std::vector<bool>& found)
+        {
+            LOGINFO("%zu entries", entries.size());
+
+            bool success = false;
+
+            found.assign(entries.size(), false);
+
+            // Same read path as getValue: no writer lock and no transaction while reading. Writers
+            // wait for mReading to drop, so no write lands between the reads of the batch
+            std::vector<size_t> missing;
+            uint64_t generation;
+            {
+                lock_guard<mutex> lck(mLock);
+                for (size_t i = 0; i < entries.size(); i++)
+                {
+                    string value;
+                    if (cacheGet(entries[i].ns, entries[i].key, value) ||
+                        findPending(entries[i].ns, entries[i].key, value))
+                    {
+                        entries[i].value = value;
+                        found[i] = true;
+                    }
+                    else
+                        missing.push_back(i);
+                }
+                generation = cacheGeneration();
+                mReading++;
+            }
+
+            sqlite3* &db = SQLITE;
+
+            if (db)
+            {
+                void* stmt = acquireReadStatement(STMT_GET_VALUE);
+
+                success = true;
+                for (size_t i = 0; success && i < missing.size(); i++)
+                {
+                    Entry& entry = entries[missing[i]];
+                    string value;
+                    int rc;
+                    success = selectItem(stmt, entry.ns, entry.key, value, rc);
+                    if (success && rc == SQLITE_ROW)
+                    {
+                        entry.value = value;
+                        found[missing[i]] = true;
+                        cachePut(entry.ns, entry.key, value, generation);
+                    }
+                }
+
+                releaseReadStatement(STMT_GET_VALUE, stmt);
+            }
+
+            mReading--;
+
+            return success;
+        }
+
+        bool PersistentStore::deleteKeys(const std::vector<Entry>& entries)
+        {
+            LOGINFO("%zu entries", entries.size());
+
+            bool success = false;
+
+            lock_guard<mutex> lck(mLock);
+            while (mReading > 0);
+            flushPending();
+            for (auto it = entries.begin(); it != entries.end(); ++it)
+                cacheErase(it->ns, it->key);
+
+            sqlite3* &db = SQLITE;
+
+            int retry = 0;
+            int rc;
+            do
+            {
+                if (!db)
+                    break;
+
+                if (beginTransaction(rc))
+                {
+                    success = true;
+                    for (auto it = entries.begin(); success && it != entries.end(); ++it)
+                        success = removeItem(it->ns, it->key, rc);
+
+                    success = endTransaction(success, rc);
+                }
+            } while (!success && SQLITE_IS_ERROR_DBWRITE(rc) && (++retry < 2) && open());
+
+            return success;
+        }
+
+        bool PersistentStore::open()
+        {
+            // Reopen whatever file was opened last, the plugin's store by default
+            if (mStoreFile.empty())
+            {
+                auto file = g_build_filename("opt", "persistent", STORE_NAME, nullptr);
+                string storeFile(file);
+                g_free(file);
+                return open(storeFile, STORE_KEY);
             }
 
-            g_free(path);
-            g_free(file);
+            return open(mStoreFile, mStoreKey);
+        }
+
+        bool PersistentStore::open(const string& file, const char* key)
+        {
+            bool result;
+
+            mStoreFile = file;
+            mStoreKey = key;
+
+            sqlite3* &db = SQLITE;
+
+            if (db && fileExists(file.c_str()))
+                result = false; // Seems open!
+            else
+            {
+                auto path = g_path_get_dirname(file.c_str());
+                if (!fileExists(path))
+                    g_mkdir_with_parents(path, 0745);
+                g_free(path);
+
+                result = init(file.c_str(), key);
+            }
 
             return result;
         }
@@ -661,6 +1017,8 @@ namespace WPEFramework {
         {
             sqlite3* &db = SQLITE;
 
+            finalizeStatements();
+
             if (db)
             {
                 int rc = sqlite3_db_cacheflush(db);
@@ -792,6 +1150,13 @@ namespace WPEFramework {
                     LOGERR("Can't remove file");
                     return false;
                 }
+                // The WAL and shared-memory files belong to the old database
+                string wal = string(filename) + "-wal";
+                string shm = string(filename) + "-shm";
+                if (fileExists(wal.c_str()))
+                    fileRemove(wal.c_str());
+                if (fileExists(shm.c_str()))
+                    fileRemove(shm.c_str());
                 rc = sqlite3_open(filename, &db);
                 term();
                 if (rc || !fileExists(filename))
@@ -833,7 +1198,687 @@ namespace WPEFramework {
                     LOGERR("%d", rc);
             }
 
+            rc = sqlite3_exec(db, "PRAGMA journal_mode = WAL;", 0, 0, &errmsg);
+            if (rc != SQLITE_OK || errmsg)
+            {
+                if (errmsg)
+                {
+                    LOGERR("%d : %s", rc, errmsg);
+                    sqlite3_free(errmsg);
+                }
+                else
+                    LOGERR("%d", rc);
+            }
+
+            string synchronous = mSynchronous;
+            Utils::String::toLower(synchronous);
+            if (synchronous != "off" && synchronous != "normal" && synchronous != "full" && synchronous != "extra")
+            {
+                LOGWARN("unknown synchronous mode '%s', using normal", mSynchronous.c_str());
+                synchronous = "normal";
+            }
+
+            rc = sqlite3_exec(db, ("PRAGMA synchronous = " + synchronous + ";").c_str(), 0, 0, &errmsg);
+            if (rc != SQLITE_OK || errmsg)
+            {
+                if (errmsg)
+                {
+                    LOGERR("%d : %s", rc, errmsg);
+                    sqlite3_free(errmsg);
+                }
+                else
+                    LOGERR("%d", rc);
+            }
+
+            prepareStatements();
+            cacheClear();
+
+            // Consistency check: the counters are rebuilt from the tables on every (re)open
+            int64_t lastSize = mTotalSize;
+            rebuildSizes();
+            if (lastSize != 0 && lastSize != mTotalSize)
+                LOGWARN("storage size was out of sync: %lld, actual %lld", (long long)lastSize, (long long)mTotalSize);
+            LOGINFO("storage size: %lld", (long long)mTotalSize);
+
             return true;
         }
+
+        const char* PersistentStore::statementSql(Statement statement)
+        {
+            static const char* sql[STMT_COUNT] = {
+                /* STMT_BEGIN */ "BEGIN;",
+                /* STMT_COMMIT */ "COMMIT;",
+                /* STMT_ROLLBACK */ "ROLLBACK;",
+                /* STMT_INSERT_NAMESPACE */ "INSERT OR IGNORE INTO namespace (name) values (?);",
+                /* STMT_INSERT_ITEM */ "INSERT INTO item (ns,key,value)"
+                                       " SELECT id, ?, ?"
+                                       " FROM namespace"
+                                       " WHERE name = ?"
+                                       ";",
+                /* STMT_ITEM_SIZE */ "SELECT length(key)+length(value)"
+                                     " FROM item"
+                                     " INNER JOIN namespace ON namespace.id = item.ns"
+                                     " where name = ? and key = ?"
+                                     ";",
+                /* STMT_DELETE_ITEM */ "DELETE FROM item"
+                                       " where ns in (select id from namespace where name = ?)"
+                                       " and key = ?"
+                                       ";",
+                /* STMT_DELETE_NAMESPACE */ "DELETE FROM namespace where name = ?;",
+                /* STMT_GET_VALUE */ "SELECT value"
+                                     " FROM item"
+                                     " INNER JOIN namespace ON namespace.id = item.ns"
+                                     " where name = ? and key = ?"
+                                     ";",
+                /* STMT_LIST_KEYS */ "SELECT key FROM item"
+                                     " where ns = (select id from namespace where name = ?)"
+                                     " and key > ? and key >= ?"
+                                     " ORDER BY key LIMIT ?;",
+                /* STMT_LIST_KEYS_BOUNDED */ "SELECT key FROM item"
+                                             " where ns = (select id from namespace where name = ?)"
+                                             " and key > ? and key >= ? and key < ?"
+                                             " ORDER BY key LIMIT ?;",
+                /* STMT_LIST_ENTRIES */ "SELECT key, value FROM item"
+                                        " where ns = (select id from namespace where name = ?)"
+                                        " and key > ? and key >= ?"
+                                        " ORDER BY key LIMIT ?;",
+                /* STMT_LIST_ENTRIES_BOUNDED */ "SELECT key, value FROM item"
+                                                " where ns = (select id from namespace where name = ?)"
+                                                " and key > ? and key >= ? and key < ?"
+                                                " ORDER BY key LIMIT ?;"
+            };
+
+            return sql[statement];
+        }
+
+        void PersistentStore::prepareStatements()
+        {
+            sqlite3* &db = SQLITE;
+
+            finalizeStatements();
+
+            // The read statements are prepared per reader by acquireReadStatement()
+            for (int i = 0; i < STMT_GET_VALUE; i++)
+            {
+                sqlite3_stmt *stmt = nullptr;
+                int rc = sqlite3_prepare_v2(db, statementSql((Statement)i), -1, &stmt, nullptr);
+                if (rc != SQLITE_OK)
+                    LOGERR("ERROR preparing statement %d: %s", i, sqlite3_errstr(rc));
+                mStatements[i] = stmt;
+            }
+        }
+
+        void PersistentStore::finalizeStatements()
+        {
+            for (int i = 0; i < STMT_COUNT; i++)
+            {
+                sqlite3_finalize(STATEMENT(i));
+                mStatements[i] = nullptr;
+            }
+
+            lock_guard<mutex> lck(mReadLock);
+            for (int i = 0; i < STMT_COUNT; i++)
+            {
+                for (auto it = mReadStatements[i].begin(); it != mReadStatements[i].end(); ++it)
+                    sqlite3_finalize((sqlite3_stmt*)*it);
+                mReadStatements[i].clear();
+            }
+        }
+
+        // Readers each use their own statement, taken from the idle ones or prepared when there is
+        // none. Only called with mReading held, so the DB is not reopened while it is in use
+        void* PersistentStore::acquireReadStatement(Statement statement)
+        {
+            {
+                lock_guard<mutex> lck(mReadLock);
+                if (!mReadStatements[statement].empty())
+                {
+                    void* stmt = mReadStatements[statement].back();
+                    mReadStatements[statement].pop_back();
+                    return stmt;
+                }
+            }
+
+            sqlite3* &db = SQLITE;
+
+            sqlite3_stmt *stmt = nullptr;
+            int rc = sqlite3_prepare_v2(db, statementSql(statement), -1, &stmt, nullptr);
+            if (rc != SQLITE_OK)
+                LOGERR("ERROR preparing statement %d: %s", statement, sqlite3_errstr(rc));
+            return stmt;
+        }
+
+        void PersistentStore::releaseReadStatement(Statement statement, void* stmt)
+        {
+            if (!stmt)
+                return;
+
+            sqlite3_reset((sqlite3_stmt*)stmt);
+            sqlite3_clear_bindings((sqlite3_stmt*)stmt);
+
+            lock_guard<mutex> lck(mReadLock);
+            mReadStatements[statement].push_back(stmt);
+        }
+
+        bool PersistentStore::beginTransaction(int& rc)
+        {
+            sqlite3_stmt *stmt = STATEMENT(STMT_BEGIN);
+            sqlite3_reset(stmt);
+
+            rc = sqlite3_step(stmt);
+            if (rc != SQLITE_DONE)
+            {
+                LOGERR("ERROR starting transaction: %s", sqlite3_errstr(rc));
+                return false;
+            }
+
+            return true;
+        }
+
+        bool PersistentStore::endTransaction(bool commit, int& rc)
+        {
+            if (commit)
+            {
+                sqlite3_stmt *stmt = STATEMENT(STMT_COMMIT);
+                sqlite3_reset(stmt);
+
+                rc = sqlite3_step(stmt);
+                if (rc == SQLITE_DONE)
+                    return true;
+
+                LOGERR("ERROR committing transaction: %s", sqlite3_errstr(rc));
+            }
+
+            sqlite3_stmt *stmt = STATEMENT(STMT_ROLLBACK);
+            sqlite3_reset(stmt);
+
+            int rollbackRc = sqlite3_step(stmt);
+            if (rollbackRc != SQLITE_DONE)
+                LOGERR("ERROR rolling back transaction: %s", sqlite3_errstr(rollbackRc));
+
+            // The counters were updated inside the transaction
+            rebuildSizes();
+
+            return false;
+        }
+
+        bool PersistentStore::insertItem(const string& ns, const string& key, const string& value, int& rc)
+        {
+            sqlite3_stmt *stmt = STATEMENT(STMT_INSERT_NAMESPACE);
+            sqlite3_reset(stmt);
+            sqlite3_clear_bindings(stmt);
+
+            sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
+
+            rc = sqlite3_step(stmt);
+            if (rc != SQLITE_DONE)
+            {
+                LOGERR("ERROR inserting data: %s", sqlite3_errstr(rc));
+                return false;
+            }
+
+            stmt = STATEMENT(STMT_ITEM_SIZE);
+            sqlite3_reset(stmt);
+            sqlite3_clear_bindings(stmt);
+
+            sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 2, key.c_str(), -1, SQLITE_TRANSIENT);
+
+            int64_t oldSize = 0;
+            rc = sqlite3_step(stmt);
+            if (rc == SQLITE_ROW)
+                oldSize = sqlite3_column_int64(stmt, 0);
+            else if (rc != SQLITE_DONE)
+            {
+                LOGERR("ERROR getting size: %s", sqlite3_errstr(rc));
+                return false;
+            }
+            sqlite3_reset(stmt);
+
+            stmt = STATEMENT(STMT_INSERT_ITEM);
+            sqlite3_reset(stmt);
+            sqlite3_clear_bindings(stmt);
+
+            sqlite3_bind_text(stmt, 1, key.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 2, value.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 3, ns.c_str(), -1, SQLITE_TRANSIENT);
+
+            rc = sqlite3_step(stmt);
+            if (rc != SQLITE_DONE)
+            {
+                LOGERR("ERROR inserting data: %s", sqlite3_errstr(rc));
+                return false;
+            }
+
+            auto it = mNamespaceSizes.find(ns);
+            if (it == mNamespaceSizes.end())
+            {
+                it = mNamespaceSizes.insert(std::make_pair(ns, (int64_t)0)).first;
+                mTotalSize += textLength(ns);
+            }
+
+            int64_t delta = textLength(key) + textLength(value) - oldSize;
+            it->second += delta;
+            mTotalSize += delta;
+
+            return true;
+        }
+
+        bool PersistentStore::removeItem(const string& ns, const string& key, int& rc)
+        {
+            sqlite3_stmt *stmt = STATEMENT(STMT_ITEM_SIZE);
+            sqlite3_reset(stmt);
+            sqlite3_clear_bindings(stmt);
+
+            sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 2, key.c_str(), -1, SQLITE_TRANSIENT);
+
+            int64_t oldSize = 0;
+            rc = sqlite3_step(stmt);
+            if (rc == SQLITE_ROW)
+                oldSize = sqlite3_column_int64(stmt, 0);
+            else if (rc != SQLITE_DONE)
+            {
+                LOGERR("ERROR getting size: %s", sqlite3_errstr(rc));
+                return false;
+            }
+            sqlite3_reset(stmt);
+
+            stmt = STATEMENT(STMT_DELETE_ITEM);
+            sqlite3_reset(stmt);
+            sqlite3_clear_bindings(stmt);
+
+            sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 2, key.c_str(), -1, SQLITE_TRANSIENT);
+
+            rc = sqlite3_step(stmt);
+            if (rc != SQLITE_DONE)
+            {
+                LOGERR("ERROR removing data: %s", sqlite3_errstr(rc));
+                return false;
+            }
+
+            auto it = mNamespaceSizes.find(ns);
+            if (it != mNamespaceSizes.end())
+            {
+                it->second -= oldSize;
+                mTotalSize -= oldSize;
+            }
+
+            return true;
+        }
+
+        bool PersistentStore::removeNamespace(const string& ns, int& rc)
+        {
+            sqlite3_stmt *stmt = STATEMENT(STMT_DELETE_NAMESPACE);
+            sqlite3_reset(stmt);
+            sqlite3_clear_bindings(stmt);
+
+            sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
+
+            rc = sqlite3_step(stmt);
+            if (rc != SQLITE_DONE)
+            {
+                LOGERR("ERROR removing data: %s", sqlite3_errstr(rc));
+                return false;
+            }
+
+            auto it = mNamespaceSizes.find(ns);
+            if (it != mNamespaceSizes.end())
+            {
+                mTotalSize -= it->second + textLength(ns);
+                mNamespaceSizes.erase(it);
+            }
+
+            return true;
+        }
+
+        bool PersistentStore::selectItem(void* statement, const string& ns, const string& key, string& value, int& rc)
+        {
+            sqlite3_stmt *stmt = (sqlite3_stmt*)statement;
+            if (!stmt)
+            {
+                rc = SQLITE_ERROR;
+                return false;
+            }
+            sqlite3_reset(stmt);
+            sqlite3_clear_bindings(stmt);
+
+            sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 2, key.c_str(), -1, SQLITE_TRANSIENT);
+
+            rc = sqlite3_step(stmt);
+            if (rc == SQLITE_ROW)
+                value = (const char*)sqlite3_column_text(stmt, 0);
+            else if (rc != SQLITE_DONE)
+            {
+                LOGERR("ERROR getting data: %s", sqlite3_errstr(rc));
+                return false;
+            }
+            sqlite3_reset(stmt);
+
+            return true;
+        }
+
+        bool PersistentStore::queueItem(const string& ns, const string& key, const string& value)
+        {
+            // The estimate counts every pending value as new, only go to the DB for the exact size once it is near the limit
+            if (mTotalSize + mPendingSize > MAX_SIZE_BYTES)
+                flushPending();
+
+            if (mTotalSize > MAX_SIZE_BYTES)
+            {
+                LOGWARN("max size exceeded: %lld", (long long)mTotalSize);
+                return false;
+            }
+
+            if (mPending.empty())
+            {
+                mPendingSince = chrono::steady_clock::now();
+                mFlushCondition.notify_all();
+            }
+
+            int64_t size = textLength(ns) + textLength(key) + textLength(value);
+            auto it = mPending.find(std::make_pair(ns, key));
+            if (it != mPending.end())
+            {
+                mPendingSize += size - (textLength(ns) + textLength(key) + textLength(it->second));
+                it->second = value;
+            }
+            else
+            {
+                mPendingSize += size;
+                mPending.insert(std::make_pair(std::make_pair(ns, key), value));
+            }
+
+            if (mPending.size() >= mFlushThreshold || mTotalSize + mPendingSize > MAX_SIZE_BYTES)
+                flushPending();
+
+            if (mTotalSize + mPendingSize > MAX_SIZE_BYTES)
+            {
+                LOGWARN("max size exceeded: %lld", (long long)(mTotalSize + mPendingSize));
+
+                JsonObject params;
+                sendNotify(C_STR(EVT_ON_STORAGE_EXCEEDED), params);
+
+                return false;
+            }
+
+            return true;
+        }
+
+        bool PersistentStore::findPending(const string& ns, const string& key, string& value) const
+        {
+            auto it = mPending.find(std::make_pair(ns, key));
+            if (it == mPending.end())
+                return false;
+
+            value = it->second;
+            return true;
+        }
+
+        bool PersistentStore::flushPending()
+        {
+            if (mPending.empty())
+                return true;
+
+            while (mReading > 0);
+
+            sqlite3* &db = SQLITE;
+
+            bool success = false;
+            int retry = 0;
+            int rc;
+            do
+            {
+                if (!db)
+                    break;
+
+                if (beginTransaction(rc))
+                {
+                    success = true;
+                    for (auto it = mPending.begin(); success && it != mPending.end(); ++it)
+                        success = insertItem(it->first.first, it->first.second, it->second, rc);
+
+                    success = endTransaction(success, rc);
+                }
+            } while (!success && SQLITE_IS_ERROR_DBWRITE(rc) && (++retry < 2) && open());
+
+            if (success)
+            {
+                mPending.clear();
+                mPendingSize = 0;
+            }
+            else
+            {
+                // Keep the values and retry after another delay
+                LOGERR("ERROR writing %zu pending values", mPending.size());
+                mPendingSince = chrono::steady_clock::now();
+            }
+
+            return success;
+        }
+
+        void PersistentStore::flushLoop()
+        {
+            unique_lock<mutex> lck(mLock);
+
+            while (!mFlushStop)
+            {
+                if (mPending.empty())
+                {
+                    mFlushCondition.wait(lck);
+                    continue;
+                }
+
+                auto deadline = mPendingSince + chrono::milliseconds(mFlushDelay);
+                if (chrono::steady_clock::now() >= deadline)
+                    flushPending();
+                else
+                    mFlushCondition.wait_until(lck, deadline);
+            }
+        }
+
+        bool PersistentStore::cacheGet(const string& ns, const string& key, string& value)
+        {
+            lock_guard<mutex> lck(mCacheLock);
+
+            if (mCacheBudget == 0)
+                return false;
+
+            auto it = mCache.find(std::make_pair(ns, key));
+            if (it == mCache.end())
+            {
+                mCacheMisses++;
+                return false;
+            }
+
+            mCacheLru.splice(mCacheLru.begin(), mCacheLru, it->second.lru);
+            value = it->second.value;
+            mCacheHits++;
+
+            return true;
+        }
+
+        void PersistentStore::cachePut(const string& ns, const string& key, const string& value, uint64_t generation)
+        {
+            lock_guard<mutex> lck(mCacheLock);
+
+            uint64_t size = cacheEntrySize(ns, key, value);
+            if (generation != mCacheGeneration || size > mCacheBudget)
+                return;
+
+            ItemKey itemKey = std::make_pair(ns, key);
+            auto it = mCache.find(itemKey);
+            if (it != mCache.end())
+            {
+                mCacheSize -= cacheEntrySize(ns, key, it->second.value);
+                it->second.value = value;
+                mCacheLru.splice(mCacheLru.begin(), mCacheLru, it->second.lru);
+            }
+            else
+            {
+                mCacheLru.push_front(itemKey);
+                CacheEntry entry;
+                entry.value = value;
+                entry.lru = mCacheLru.begin();
+                mCache.insert(std::make_pair(itemKey, entry));
+            }
+            mCacheSize += size;
+
+            while (mCacheSize > mCacheBudget)
+            {
+                auto last = mCache.find(mCacheLru.back());
+                mCacheSize -= cacheEntrySize(last->first.first, last->first.second, last->second.value);
+                mCache.erase(last);
+                mCacheLru.pop_back();
+                mCacheEvictions++;
+            }
+        }
+
+        void PersistentStore::cacheErase(const string& ns, const string& key)
+        {
+            lock_guard<mutex> lck(mCacheLock);
+
+            mCacheGeneration++;
+
+            auto it = mCache.find(std::make_pair(ns, key));
+            if (it != mCache.end())
+            {
+                mCacheSize -= cacheEntrySize(ns, key, it->second.value);
+                mCacheLru.erase(it->second.lru);
+                mCache.erase(it);
+            }
+        }
+
+        void PersistentStore::cacheEraseNamespace(const string& ns)
+        {
+            lock_guard<mutex> lck(mCacheLock);
+
+            mCacheGeneration++;
+
+            // Keys of a namespace are contiguous in the map
+            auto it = mCache.lower_bound(std::make_pair(ns, string()));
+            while (it != mCache.end() && it->first.first == ns)
+            {
+                mCacheSize -= cacheEntrySize(ns, it->first.second, it->second.value);
+                mCacheLru.erase(it->second.lru);
+                it = mCache.erase(it);
+            }
+        }
+
+        void PersistentStore::cacheClear()
+        {
+            lock_guard<mutex> lck(mCacheLock);
+
+            mCacheGeneration++;
+            mCache.clear();
+            mCacheLru.clear();
+            mCacheSize = 0;
+        }
+
+        uint64_t PersistentStore::cacheGeneration()
+        {
+            lock_guard<mutex> lck(mCacheLock);
+            return mCacheGeneration;
+        }
+
+        // Range scan on the (ns,key) index, in key order, starting after cursor (the last key of the
+        // previous page). limit 0 means no limit. nextCursor is set only if there are more keys.
+        bool PersistentStore::listItems(const string& ns, const string& prefix, const string& cursor, uint32_t limit, bool withValues, std::vector<Entry>& entries, string& nextCursor)
+        {
+            bool success = false;
+
+            {
+                lock_guard<mutex> lck(mLock);
+                flushPending();
+                mReading++;
+            }
+
+            sqlite3* &db = SQLITE;
+
+            entries.clear();
+            nextCursor.clear();
+
+            if (db)
+            {
+                string end;
+                bool bounded = !prefix.empty() && prefixEnd(prefix, end);
+
+                Statement query = withValues ? (bounded ? STMT_LIST_ENTRIES_BOUNDED : STMT_LIST_ENTRIES)
+                                             : (bounded ? STMT_LIST_KEYS_BOUNDED : STMT_LIST_KEYS);
+
+                sqlite3_stmt *stmt = (sqlite3_stmt*)acquireReadStatement(query);
+                if (!stmt)
+                {
+                    mReading--;
+                    return false;
+                }
+
+                int index = 1;
+                sqlite3_bind_text(stmt, index++, ns.c_str(), -1, SQLITE_TRANSIENT);
+                sqlite3_bind_text(stmt, index++, cursor.c_str(), -1, SQLITE_TRANSIENT);
+                sqlite3_bind_text(stmt, index++, prefix.c_str(), -1, SQLITE_TRANSIENT);
+                if (bounded)
+                    sqlite3_bind_text(stmt, index++, end.c_str(), -1, SQLITE_TRANSIENT);
+                // One extra row tells whether there is a next page
+                sqlite3_bind_int64(stmt, index++, limit == 0 ? -1 : (sqlite3_int64)limit + 1);
+
+                if (limit != 0)
+                    entries.reserve(std::min(limit, MAX_PAGE_SIZE));
+
+                while (sqlite3_step(stmt) == SQLITE_ROW)
+                {
+                    if (limit != 0 && entries.size() == limit)
+                    {
+                        nextCursor = entries.back().key;
+                        break;
+                    }
+
+                    Entry entry;
+                    entry.key = (const char*)sqlite3_column_text(stmt, 0);
+                    if (withValues)
+                        entry.value = (const char*)sqlite3_column_text(stmt, 1);
+                    entries.push_back(entry);
+                }
+
+                releaseReadStatement(query, stmt);
+                success = true;
+            }
+
+            mReading--;
+
+            return success;
+        }
+
+        void PersistentStore::rebuildSizes()
+        {
+            sqlite3* &db = SQLITE;
+
+            std::map<string, int64_t> namespaceSizes;
+            int64_t totalSize = 0;
+
+            if (db)
+            {
+                sqlite3_stmt *stmt;
+                sqlite3_prepare_v2(db, "SELECT name, length(name), sum(length(key)+length(value))"
+                                       " FROM namespace"
+                                       " LEFT JOIN item ON namespace.id = item.ns"
+                                       " GROUP BY name"
+                                       ";", -1, &stmt, nullptr);
+
+                while (sqlite3_step(stmt) == SQLITE_ROW)
+                {
+                    int64_t size = sqlite3_column_int64(stmt, 2);
+                    namespaceSizes[(const char*)sqlite3_column_text(stmt, 0)] = size;
+                    totalSize += sqlite3_column_int64(stmt, 1) + size;
+                }
+
+                sqlite3_finalize(stmt);
+            }
+
+            mNamespaceSizes.swap(namespaceSizes);
+            mTotalSize = totalSize;
+        }
     } // namespace Plugin
 } // namespace WPEFramework
@@ -6,14 +6,24 @@
 
 #include <vector>
 #include <map>
+#include <list>
 #include <mutex>
 #include <atomic>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
 
 namespace WPEFramework {
 
     namespace Plugin {
 
+        class PersistentStoreBenchmark;
+
         class PersistentStore :  public AbstractPlugin {
+        private:
+            // Drives the storage engine directly, see benchmark/
+            friend class PersistentStoreBenchmark;
+
         public:
             PersistentStore();
             virtual ~PersistentStore();
@@ -37,6 +47,11 @@ namespace WPEFramework {
             static const string METHOD_GET_NAMESPACES;
             static const string METHOD_GET_STORAGE_SIZE;
             static const string METHOD_FLUSH_CACHE;
+            static const string METHOD_SET_VALUES;
+            static const string METHOD_GET_VALUES;
+            static const string METHOD_DELETE_KEYS;
+            static const string METHOD_GET_CACHE_STATS;
+            static const string METHOD_GET_ENTRIES;
             //events
             static const string EVT_ON_STORAGE_EXCEEDED;
             //other
@@ -44,6 +59,8 @@ namespace WPEFramework {
             static const char* STORE_KEY;
             static const int64_t MAX_SIZE_BYTES;
             static const int64_t MAX_VALUE_SIZE_BYTES;
+            static const uint32_t DEFAULT_PAGE_SIZE;
+            static const uint32_t MAX_PAGE_SIZE;
 
         private/*registered methods (wrappers)*/:
 
@@ -56,6 +73,56 @@ namespace WPEFramework {
             uint32_t getNamespacesWrapper(const JsonObject& parameters, JsonObject& response);
             uint32_t getStorageSizeWrapper(const JsonObject& parameters, JsonObject& response);
             uint32_t flushCacheWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t setValuesWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getValuesWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t deleteKeysWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getCacheStatsWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getEntriesWrapper(const JsonObject& parameters, JsonObject& response);
+
+        private/*types*/:
+            struct Entry {
+                string ns;
+                string key;
+                string value;
+            };
+
+            class Config : public Core::JSON::Container {
+            private:
+                Config(const Config&) = delete;
+                Config& operator=(const Config&) = delete;
+
+            public:
+                Config()
+                    : WriteBehind(false)
+                    , FlushDelay(1000)
+                    , FlushThreshold(64)
+                    , Synchronous(_T("normal"))
+                    , CacheSize(262144)
+                {
+                    Add(_T("writebehind"), &WriteBehind);
+                    Add(_T("flushdelay"), &FlushDelay);
+                    Add(_T("flushthreshold"), &FlushThreshold);
+                    Add(_T("synchronous"), &Synchronous);
+                    Add(_T("cachesize"), &CacheSize);
+                }
+                ~Config()
+                {
+                }
+
+            public:
+                Core::JSON::Boolean WriteBehind;
+                Core::JSON::DecUInt32 FlushDelay;
+                Core::JSON::DecUInt32 FlushThreshold;
+                Core::JSON::String Synchronous;
+                Core::JSON::DecUInt32 CacheSize;
+            };
+
+            typedef std::pair<string, string> ItemKey;
+
+            struct CacheEntry {
+                string value;
+                std::list<ItemKey>::iterator lru;
+            };
 
         private/*internal methods*/:
             PersistentStore(const PersistentStore&) = delete;
@@ -66,18 +133,111 @@ namespace WPEFramework {
             bool deleteKey(const string& ns, const string& key);
             bool deleteNamespace(const string& ns);
             bool getKeys(const string& ns, std::vector<string>& keys);
+            bool getKeys(const string& ns, const string& prefix, const string& cursor, uint32_t limit, std::vector<string>& keys, string& nextCursor);
+            bool getEntries(const string& ns, const string& prefix, const string& cursor, uint32_t limit, std::vector<Entry>& entries, string& nextCursor);
             bool getNamespaces(std::vector<string>& namespaces);
             bool getStorageSize(std::map<string, uint64_t>& namespaceSizes);
             bool flushCache();
+            bool setValues(const std::vector<Entry>& entries);
+            bool getValues(std::vector<Entry>& entries, std::vector<bool>& found);
+            bool deleteKeys(const std::vector<Entry>& entries);
 
             bool open();
+            bool open(const string& file, const char* key);
             void term();
             void vacuum();
             bool init(const char* filename, const char* key = nullptr);
 
+            // Statements prepared once in init() and reused by the write path.
+            // Only used with mLock held and no readers in flight. The read queries, from
+            // STMT_GET_VALUE on, are not kept in mStatements: every reader takes its own
+            // copy from mReadStatements, so readers still run concurrently.
+            enum Statement {
+                STMT_BEGIN,
+                STMT_COMMIT,
+                STMT_ROLLBACK,
+                STMT_INSERT_NAMESPACE,
+                STMT_INSERT_ITEM,
+                STMT_ITEM_SIZE,
+                STMT_DELETE_ITEM,
+                STMT_DELETE_NAMESPACE,
+                STMT_GET_VALUE,
+                STMT_LIST_KEYS,
+                STMT_LIST_KEYS_BOUNDED,
+                STMT_LIST_ENTRIES,
+                STMT_LIST_ENTRIES_BOUNDED,
+                STMT_COUNT
+            };
+
+            static const char* statementSql(Statement statement);
+            static bool parseEntries(const JsonObject& parameters, const char* name, bool withValue, std::vector<Entry>& entries, JsonObject& response);
+
+            void prepareStatements();
+            void finalizeStatements();
+            void* acquireReadStatement(Statement statement);
+            void releaseReadStatement(Statement statement, void* stmt);
+            bool beginTransaction(int& rc);
+            bool endTransaction(bool commit, int& rc);
+            bool insertItem(const string& ns, const string& key, const string& value, int& rc);
+            bool removeItem(const string& ns, const string& key, int& rc);
+            bool removeNamespace(const string& ns, int& rc);
+            bool selectItem(void* stmt, const string& ns, const string& key, string& value, int& rc);
+            bool listItems(const string& ns, const string& prefix, const string& cursor, uint32_t limit, bool withValues, std::vector<Entry>& entries, string& nextCursor);
+            bool queueItem(const string& ns, const string& key, const string& value);
+            bool findPending(const string& ns, const string& key, string& value) const;
+            bool flushPending();
+            void flushLoop();
+            bool cacheGet(const string& ns, const string& key, string& value);
+            void cachePut(const string& ns, const string& key, const string& value, uint64_t generation);
+            void cacheErase(const string& ns, const string& key);
+            void cacheEraseNamespace(const string& ns);
+            void cacheClear();
+            uint64_t cacheGeneration();
+            void rebuildSizes();
+
             void* mData;
+            // File and key of the last open(), used again when a failed write reopens the DB
+            string mStoreFile;
+            const char* mStoreKey;
+            void* mStatements[STMT_COUNT];
             std::mutex mLock;
             std::atomic<int> mReading;
+            // Idle read statements, guarded by mReadLock
+            std::vector<void*> mReadStatements[STMT_COUNT];
+            std::mutex mReadLock;
+
+            // Running totals mirroring "sum(length(key)+length(value))" per namespace
+            // and the overall quota size (items + namespace names). Guarded by mLock.
+            std::map<string, int64_t> mNamespaceSizes;
+            int64_t mTotalSize;
+
+            // Write-behind: values accepted but not yet committed, served to readers first
+            // and written as one transaction after mFlushDelay ms or mFlushThreshold entries.
+            // mPendingSize over-estimates their quota share (every entry counted as new).
+            bool mWriteBehind;
+            uint32_t mFlushDelay;
+            uint32_t mFlushThreshold;
+            string mSynchronous;
+            std::map<ItemKey, string> mPending;
+            int64_t mPendingSize;
+            std::chrono::steady_clock::time_point mPendingSince;
+            std::thread mFlushThread;
+            std::condition_variable mFlushCondition;
+            bool mFlushStop;
+
+            // Read-through cache of (namespace, key) -> value with LRU eviction once the
+            // estimated size goes over mCacheBudget bytes (0 disables it). Writers invalidate
+            // entries and bump mCacheGeneration so readers that started earlier don't re-insert
+            // what they read before the write. Guarded by mCacheLock.
+            std::mutex mCacheLock;
+            std::map<ItemKey, CacheEntry> mCache;
+            std::list<ItemKey> mCacheLru;
+            uint64_t mCacheBudget;
+            uint64_t mCacheSize;
+            uint64_t mCacheGeneration;
+            uint64_t mCacheHits;
+            uint64_t mCacheMisses;
+            uint64_t mCacheEvictions;
         };
     } // namespace Plugin
 } // namespace WPEFramework
@@ -0,0 +1,443 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+/**
+ * @file PersistentStoreBenchmark.cpp
+ * @brief Drives the PersistentStore storage engine (setValue, getValue, getKeys, deleteNamespace)
+ * against a temporary database file, without a running Thunder, and reports ops/sec and latency
+ * percentiles per operation.
+ */
+
+#include "PersistentStore.h"
+
+#include <getopt.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        class PersistentStoreBenchmark {
+        public:
+            enum Operation {
+                OP_SET_VALUE,
+                OP_GET_VALUE,
+                OP_GET_KEYS,
+                OP_DELETE_NAMESPACE,
+                OP_COUNT
+            };
+
+            struct Options {
+                string path;
+                bool encrypt;
+                bool writeBehind;
+                uint32_t cacheSize;
+                uint32_t threads;
+                uint32_t operations;
+                uint32_t namespaces;
+                uint32_t keys;
+                uint32_t keySizeMin;
+                uint32_t keySizeMax;
+                uint32_t valueSizeMin;
+                uint32_t valueSizeMax;
+                uint32_t mix[OP_COUNT];
+                bool verbose;
+            };
+
+            PersistentStoreBenchmark(const Options& options)
+                : _options(options)
+                , _store(Core::Service<PersistentStore>::Create<PersistentStore>())
+            {
+            }
+
+            ~PersistentStoreBenchmark()
+            {
+                _store->Release();
+            }
+
+            bool Run()
+            {
+                if (!Open())
+                    return false;
+
+                Populate();
+
+                vector<vector<uint64_t>> latencies[OP_COUNT];
+                for (int op = 0; op < OP_COUNT; op++)
+                    latencies[op].resize(_options.threads);
+
+                auto start = chrono::steady_clock::now();
+
+                vector<thread> workers;
+                for (uint32_t i = 0; i < _options.threads; i++)
+                {
+                    workers.push_back(thread([this, i, &latencies]() {
+                        vector<uint64_t>* results[OP_COUNT];
+                        for (int op = 0; op < OP_COUNT; op++)
+                            results[op] = &latencies[op][i];
+                        Work(i, results);
+                    }));
+                }
+                for (auto it = workers.begin(); it != workers.end(); ++it)
+                    it->join();
+
+                double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+                Close();
+
+                Report(latencies, elapsed);
+
+                return true;
+            }
+
+        private:
+            bool Open()
+            {
+                _store->mWriteBehind = _options.writeBehind;
+                _store->mCacheBudget = _options.cacheSize;
+
+                // Same key the plugin uses, so the encrypted (SQLITE_HAS_CODEC) build goes through the codec
+                if (!_store->open(_options.path, _options.encrypt ? PersistentStore::STORE_KEY : nullptr))
+                {
+                    cerr << "can't open " << _options.path << endl;
+                    return false;
+                }
+
+                if (_options.writeBehind)
+                {
+                    _store->mFlushStop = false;
+                    _store->mFlushThread = std::thread(&PersistentStore::flushLoop, _store);
+                }
+
+                return true;
+            }
+
+            void Close()
+            {
+                if (_store->mFlushThread.joinable())
+                {
+                    {
+                        lock_guard<mutex> lck(_store->mLock);
+                        _store->mFlushStop = true;
+                    }
+                    _store->mFlushCondition.notify_all();
+                    _store->mFlushThread.join();
+                }
+
+                {
+                    lock_guard<mutex> lck(_store->mLock);
+                    _store->flushPending();
+                }
+
+                _store->term();
+            }
+
+            // Writes every key once so reads hit existing data
+            void Populate()
+            {
+                mt19937 random(0);
+
+                vector<PersistentStore::Entry> entries;
+                for (uint32_t ns = 0; ns < _options.namespaces; ns++)
+                {
+                    for (uint32_t key = 0; key < _options.keys; key++)
+                    {
+                        PersistentStore::Entry entry;
+                        entry.ns = Namespace(ns);
+                        entry.key = Key(key);
+                        entry.value = Value(random);
+                        entries.push_back(entry);
+                    }
+                }
+
+                if (!entries.empty() && !_store->setValues(entries))
+                    cerr << "populate failed, storage limit is " << PersistentStore::MAX_SIZE_BYTES << " bytes" << endl;
+            }
+
+            void Work(uint32_t index, vector<uint64_t>* results[OP_COUNT])
+            {
+                mt19937 random(index + 1);
+
+                uint32_t total = 0;
+                for (int op = 0; op < OP_COUNT; op++)
+                    total += _options.mix[op];
+
+                uint32_t operations = _options.operations / _options.threads;
+                for (int op = 0; op < OP_COUNT; op++)
+                    results[op]->reserve(operations * _options.mix[op] / total + 1);
+
+                for (uint32_t i = 0; i < operations; i++)
+                {
+                    uint32_t pick = random() % total;
+                    int op = 0;
+                    while (pick >= _options.mix[op])
+                        pick -= _options.mix[op++];
+
+                    string ns = Namespace(random() % _options.namespaces);
+                    string key = Key(random() % _options.keys);
+                    string value;
+                    vector<string> keys;
+
+                    if (op == OP_SET_VALUE)
+                        value = Value(random);
+
+                    auto start = chrono::steady_clock::now();
+
+                    bool success = false;
+                    switch (op)
+                    {
+                    case OP_SET_VALUE:
+                        success = _store->setValue(ns, key, value);
+                        break;
+                    case OP_GET_VALUE:
+                        success = _store->getValue(ns, key, value);
+                        break;
+                    case OP_GET_KEYS:
+                        success = _store->getKeys(ns, keys);
+                        break;
+                    case OP_DELETE_NAMESPACE:
+                        success = _store->deleteNamespace(ns);
+                        break;
+                    }
+
+                    results[op]->push_back(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
+
+                    if (!success && _options.verbose)
+                        cerr << "operation " << op << " failed: " << ns << " " << key << endl;
+                }
+            }
+
+            void Report(vector<vector<uint64_t>> latencies[OP_COUNT], double elapsed) const
+            {
+                static const char* names[OP_COUNT] = { "setValue", "getValue", "getKeys", "deleteNamespace" };
+
+                uint64_t count = 0;
+
+                cout << left << setw(16) << "operation" << right
+                     << setw(10) << "count" << setw(12) << "ops/sec"
+                     << setw(12) << "p50 us" << setw(12) << "p99 us" << setw(12) << "p999 us" << endl;
+
+                for (int op = 0; op < OP_COUNT; op++)
+                {
+                    vector<uint64_t> all;
+                    for (auto it = latencies[op].begin(); it != latencies[op].end(); ++it)
+                        all.insert(all.end(), it->begin(), it->end());
+
+                    if (all.empty())
+                        continue;
+
+                    sort(all.begin(), all.end());
+                    count += all.size();
+
+                    cout << left << setw(16) << names[op] << right
+                         << setw(10) << all.size()
+                         << setw(12) << fixed << setprecision(0) << all.size() / elapsed
+                         << setw(12) << setprecision(1) << Percentile(all, 0.50) / 1000.0
+                         << setw(12) << Percentile(all, 0.99) / 1000.0
+                         << setw(12) << Percentile(all, 0.999) / 1000.0 << endl;
+                }
+
+                cout << left << setw(16) << "total" << right
+                     << setw(10) << count
+                     << setw(12) << setprecision(0) << count / elapsed << endl;
+            }
+
+            static uint64_t Percentile(const vector<uint64_t>& sorted, double p)
+            {
+                size_t index = (size_t)(p * (sorted.size() - 1) + 0.5);
+                return sorted[index];
+            }
+
+            static string Namespace(uint32_t index)
+            {
+                return "ns" + to_string(index);
+            }
+
+            // Key index first so keys stay distinct, padded to a size in range that only depends on the index
+            string Key(uint32_t index) const
+            {
+                string key = "key" + to_string(index);
+                uint32_t size = _options.keySizeMin;
+                if (_options.keySizeMax > _options.keySizeMin)
+                    size += (index * 2654435761u) % (_options.keySizeMax - _options.keySizeMin + 1);
+                if (key.size() < size)
+                    key.append(size - key.size(), 'k');
+                return key;
+            }
+
+            string Value(mt19937& random) const
+            {
+                return string(Size(_options.valueSizeMin, _options.valueSizeMax, random), 'v');
+            }
+
+            static uint32_t Size(uint32_t min, uint32_t max, mt19937& random)
+            {
+                return max > min ? min + random() % (max - min + 1) : min;
+            }
+
+        private:
+            Options _options;
+            PersistentStore* _store;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
+
+namespace {
+    void usage(const char* name)
+    {
+        cout << "Usage: " << name << " [options]" << endl
+             << "  -f, --file PATH          database file (default: temporary file, removed at exit)" << endl
+             << "  -e, --encrypt            attach the store key (SQLITE_HAS_CODEC builds)" << endl
+             << "  -w, --write-behind       queue writes and commit them in groups" << endl
+             << "  -c, --cache BYTES        read cache budget, 0 disables it (default 262144)" << endl
+             << "  -t, --threads N          worker threads (default 1)" << endl
+             << "  -n, --operations N       operations over all threads (default 10000)" << endl
+             << "  -s, --namespaces N       namespaces (default 4)" << endl
+             << "  -k, --keys N             keys per namespace (default 100)" << endl
+             << "  -K, --key-size MIN[:MAX] key size in bytes (default 8:32)" << endl
+             << "  -V, --value-size MIN[:MAX] value size in bytes (default 16:1000)" << endl
+             << "  -m, --mix S:G:K:D        weights of setValue:getValue:getKeys:deleteNamespace (default 20:75:4:1)" << endl
+             << "  -v, --verbose            keep the plugin logging and report failed operations" << endl;
+    }
+
+    bool parseRange(const char* arg, uint32_t& min, uint32_t& max)
+    {
+        char* end;
+        min = strtoul(arg, &end, 10);
+        max = min;
+        if (*end == ':')
+            max = strtoul(end + 1, &end, 10);
+        return *end == '\0' && min <= max;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    WPEFramework::Plugin::PersistentStoreBenchmark::Options options;
+    options.encrypt = false;
+    options.writeBehind = false;
+    options.cacheSize = 262144;
+    options.threads = 1;
+    options.operations = 10000;
+    options.namespaces = 4;
+    options.keys = 100;
+    options.keySizeMin = 8;
+    options.keySizeMax = 32;
+    options.valueSizeMin = 16;
+    options.valueSizeMax = 1000;
+    options.mix[0] = 20;
+    options.mix[1] = 75;
+    options.mix[2] = 4;
+    options.mix[3] = 1;
+    options.verbose = false;
+
+    static const struct option longOptions[] = {
+        { "file", required_argument, nullptr, 'f' },
+        { "encrypt", no_argument, nullptr, 'e' },
+        { "write-behind", no_argument, nullptr, 'w' },
+        { "cache", required_argument, nullptr, 'c' },
+        { "threads", required_argument, nullptr, 't' },
+        { "operations", required_argument, nullptr, 'n' },
+        { "namespaces", required_argument, nullptr, 's' },
+        { "keys", required_argument, nullptr, 'k' },
+        { "key-size", required_argument, nullptr, 'K' },
+        { "value-size", required_argument, nullptr, 'V' },
+        { "mix", required_argument, nullptr, 'm' },
+        { "verbose", no_argument, nullptr, 'v' },
+        { "help", no_argument, nullptr, 'h' },
+        { nullptr, 0, nullptr, 0 }
+    };
+
+    int opt;
+    bool valid = true;
+    while (valid && (opt = getopt_long(argc, argv, "f:ewc:t:n:s:k:K:V:m:vh", longOptions, nullptr)) != -1)
+    {
+        switch (opt)
+        {
+        case 'f': options.path = optarg; break;
+        case 'e': options.encrypt = true; break;
+        case 'w': options.writeBehind = true; break;
+        case 'c': options.cacheSize = strtoul(optarg, nullptr, 10); break;
+        case 't': options.threads = strtoul(optarg, nullptr, 10); break;
+        case 'n': options.operations = strtoul(optarg, nullptr, 10); break;
+        case 's': options.namespaces = strtoul(optarg, nullptr, 10); break;
+        case 'k': options.keys = strtoul(optarg, nullptr, 10); break;
+        case 'K': valid = parseRange(optarg, options.keySizeMin, options.keySizeMax); break;
+        case 'V': valid = parseRange(optarg, options.valueSizeMin, options.valueSizeMax); break;
+        case 'm':
+            valid = sscanf(optarg, "%u:%u:%u:%u", &options.mix[0], &options.mix[1], &options.mix[2], &options.mix[3]) == 4
+                && options.mix[0] + options.mix[1] + options.mix[2] + options.mix[3] > 0;
+            break;
+        case 'v': options.verbose = true; break;
+        default: valid = false; break;
+        }
+    }
+
+    if (!valid || options.threads == 0 || options.namespaces == 0 || options.keys == 0
+        || options.keySizeMax == 0 || options.keySizeMax > 1000 || options.valueSizeMax > 1000)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    bool temporary = options.path.empty();
+    if (temporary)
+    {
+        char path[] = "/tmp/persistentstore-benchmark-XXXXXX";
+        int fd = mkstemp(path);
+        if (fd < 0)
+        {
+            perror("mkstemp");
+            return 1;
+        }
+        close(fd);
+        unlink(path);
+        options.path = path;
+    }
+
+    // The engine logs every call to stderr
+    if (!options.verbose && freopen("/dev/null", "w", stderr) == nullptr)
+        perror("freopen");
+
+    bool success;
+    {
+        WPEFramework::Plugin::PersistentStoreBenchmark benchmark(options);
+        success = benchmark.Run();
+    }
+
+    if (temporary)
+    {
+        unlink(options.path.c_str());
+        unlink((options.path + "-wal").c_str());
+        unlink((options.path + "-shm").c_str());
+    }
+
+    return success ? 0 : 1;
+}
@@ -24,8 +24,17 @@
 #include <iostream>
 #include <mutex>
 #include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <future>
 #include <fstream>
 #include <sstream>
+#include <list>
+#include <deque>
+#include <set>
+#include <vector>
 #include <unistd.h>
 #include <rdkshell/compositorcontroller.h>
 #include <rdkshell/application.h>
@@ -37,6 +46,14 @@
 #include <rdkshell/eastereggs.h>
 #include <rdkshell/linuxkeys.h>
 #include "base64.h"
+#ifdef RDKSHELL_SCREENSHOT_PNG
+#include <png.h>
+#endif
+#ifdef RDKSHELL_SCREENSHOT_JPEG
+#include <stdio.h>
+#include <setjmp.h>
+#include <jpeglib.h>
+#endif
 
 #ifdef RDKSHELL_READ_MAC_ON_STARTUP
 #include "FactoryProtectHal.h"
@@ -114,6 +131,15 @@ const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_GET_VIRTUAL_DISPLAY
 const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_GET_LAST_WAKEUP_KEY = "getLastWakeupKey";
 const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_GET_SCREENSHOT = "getScreenshot";
 const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_ENABLE_EASTER_EGGS = "enableEasterEggs";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_APPLY_LAYOUT = "applyLayout";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_ACKNOWLEDGE_WILL_DESTROY = "acknowledgeWillDestroy";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_GET_FRAME_STATS = "getFrameStats";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_SET_FRAME_STATS_INTERVAL = "setFrameStatsInterval";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_GET_LAUNCH_HISTORY = "getLaunchHistory";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_SET_PREWARM_APPS = "setPrewarmApps";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_GET_PREWARM_APPS = "getPrewarmApps";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_CANCEL_GENERATE_KEY = "cancelGenerateKey";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_SET_EVICTION_POLICY = "setEvictionPolicy";
 
 
 const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_ON_USER_INACTIVITY = "onUserInactivity";
@@ -138,6 +164,12 @@ const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_ON_WILL_DESTROY = "o
 const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_ON_SCREENSHOT_COMPLETE = "onScreenshotComplete";
 const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_ON_FOCUS = "onFocus";
 const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_ON_BLUR = "onBlur";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_SIZE_CHANGE_COMPLETE = "onSizeChangeComplete";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_ON_BOUNDS_APPLIED = "onBoundsApplied";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_ON_FRAME_STATS = "onFrameStats";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_ON_LAUNCH_TIMELINE = "onLaunchTimeline";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_ON_KEY_SEQUENCE_COMPLETE = "onKeySequenceComplete";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_ON_APP_EVICTED = "onAppEvicted";
 
 using namespace std;
 using namespace RdkShell;
@@ -163,14 +195,19 @@ bool sFactoryModeStart = false;
 bool sFactoryModeBlockResidentApp = false;
 bool sForceResidentAppLaunch = false;
 static bool sRunning = true;
-bool needsScreenshot = false;
 
 #define ANY_KEY 65536
 #define RDKSHELL_THUNDER_TIMEOUT 20000
 #define RDKSHELL_POWER_TIME_WAIT 2.5
 #define THUNDER_ACCESS_DEFAULT_VALUE "127.0.0.1:9998"
 #define RDKSHELL_WILLDESTROY_EVENT_WAITTIME 1
-#define RDKSHELL_TRY_LOCK_WAIT_TIME_IN_MS 250
+#define RDKSHELL_SCREENSHOT_JPEG_QUALITY 90
+#define RDKSHELL_FRAME_FENCE_TIMEOUT_IN_MS 1000
+#define RDKSHELL_SNAPSHOT_REFRESH_INTERVAL_IN_MS 1000
+#define RDKSHELL_FRAME_STATS_BUCKETS 12
+#define RDKSHELL_LAUNCH_HISTORY_SIZE 32
+#define RDKSHELL_PREWARM_CHECK_INTERVAL_IN_SECONDS 10
+#define RDKSHELL_PREWARM_IDLE_TIME_IN_SECONDS 30
 
 static std::string gThunderAccessValue = THUNDER_ACCESS_DEFAULT_VALUE;
 static uint32_t gWillDestroyEventWaitTime = RDKSHELL_WILLDESTROY_EVENT_WAITTIME;
@@ -342,102 +379,1192 @@ namespace WPEFramework {
                mLaunchEnabled = false;
             }
 
-            if (isSuspended)
-            {
-                JsonObject params;
-                params["client"] = mCallSign;
-                mRDKShell.notify(RDKShell::RDKSHELL_EVENT_ON_PLUGIN_SUSPENDED, params);
-            }            
-          }
+            if (isSuspended)
+            {
+                JsonObject params;
+                params["client"] = mCallSign;
+                mRDKShell.notify(RDKShell::RDKSHELL_EVENT_ON_PLUGIN_SUSPENDED, params);
+            }            
+          }
+
+          BEGIN_INTERFACE_MAP(Notification)
+          INTERFACE_ENTRY(PluginHost::IStateControl::INotification)
+          END_INTERFACE_MAP
+        };
+
+        std::map<std::string, StateControlNotification*> gStateNotifications;
+
+        struct RDKShellStartupConfig
+        {
+            std::string rfc;
+            std::string thunderApi;
+            JsonObject params;
+        };
+
+        std::map<std::string, PluginData> gActivePluginsData;
+        std::map<std::string, PluginStateChangeData*> gPluginsEventListener;
+        std::vector<RDKShellStartupConfig> gStartupConfigs;
+        std::map<std::string, bool> gDestroyApplications;
+        std::map<std::string, bool> gLaunchApplications;
+
+        // records how long each phase of a launch took, in microseconds from the start of the launch
+        class LaunchTimeline
+        {
+        public:
+            LaunchTimeline(const std::string& callsign)
+                : mCallsign(callsign)
+                , mStart(std::chrono::steady_clock::now())
+                , mPhaseStart(mStart)
+            {
+            }
+
+            // closes the phase that started at the previous mark
+            void mark(const std::string& phase)
+            {
+                std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                JsonObject phaseInfo;
+                phaseInfo["name"] = phase;
+                phaseInfo["start"] = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(mPhaseStart - mStart).count();
+                phaseInfo["duration"] = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(now - mPhaseStart).count();
+                mPhases.Add(phaseInfo);
+                mPhaseStart = now;
+            }
+
+            void finish(const std::string& launchType, const bool success, JsonObject& timeline)
+            {
+                timeline["callsign"] = mCallsign;
+                timeline["launchType"] = launchType;
+                timeline["success"] = success;
+                timeline["timestamp"] = (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+                timeline["total"] = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - mStart).count();
+                timeline["phases"] = mPhases;
+            }
+
+        private:
+            std::string mCallsign;
+            std::chrono::steady_clock::time_point mStart;
+            std::chrono::steady_clock::time_point mPhaseStart;
+            JsonArray mPhases;
+        };
+
+        static std::deque<JsonObject> gLaunchHistory;
+        static std::mutex gLaunchHistoryMutex;
+
+        static void addLaunchHistory(const JsonObject& timeline)
+        {
+            std::lock_guard<std::mutex> lock(gLaunchHistoryMutex);
+            gLaunchHistory.push_back(timeline);
+            while (gLaunchHistory.size() > RDKSHELL_LAUNCH_HISTORY_SIZE)
+            {
+                gLaunchHistory.pop_front();
+            }
+        }
+
+        // apps that are launched suspended and invisible while the device is idle, so that a later launch of
+        // the same callsign only has to resume them. warm instances are destroyed first when ram runs low
+        struct PrewarmApp
+        {
+            std::string callsign;
+            std::string type;
+            std::string uri;
+        };
+
+        static std::vector<PrewarmApp> gPrewarmApps;
+        static std::set<std::string> gPrewarmedApps;
+        static std::mutex gPrewarmMutex;
+        static std::condition_variable gPrewarmCondition;
+        static std::thread gPrewarmThread;
+        static bool gPrewarmThreadRunning = false;
+        static bool gPrewarmEvictRequested = false;
+        static bool gLowRamWarningActive = false;
+        static double gLowRamThresholdMb = 0;
+        static double gLastLaunchTime = 0;
+        static uint32_t gPrewarmIdleTime = RDKSHELL_PREWARM_IDLE_TIME_IN_SECONDS;
+
+        // optional eviction of suspended and hidden apps on low ram, run by the prewarm thread after the warm
+        // instances are gone. apps are ranked by the time they last had focus and then by resident memory
+        static bool gEvictionEnabled = false;
+        static bool gEvictionRequested = false;
+        static std::set<std::string> gEvictionProtectedApps;
+        // apps that are never evicted in addition to the ones passed to setEvictionPolicy, from the comma
+        // separated RDKSHELL_EVICTION_PROTECTED_APPS (the factory app when it is not set)
+        static std::set<std::string> gEvictionConfiguredProtectedApps;
+        static std::map<std::string, double> gLastForegroundTime;
+        static std::mutex gLastForegroundTimeMutex;
+
+        static void setLowRamWarningActive(const bool active)
+        {
+            std::lock_guard<std::mutex> lock(gPrewarmMutex);
+            gLowRamWarningActive = active;
+            if (active && !gPrewarmedApps.empty())
+            {
+                gPrewarmEvictRequested = true;
+                gPrewarmCondition.notify_one();
+            }
+            if (active && gEvictionEnabled)
+            {
+                gEvictionRequested = true;
+                gPrewarmCondition.notify_one();
+            }
+        }
+
+        // apps that were sent onWillDestroy are destroyed as soon as they acknowledge it or deactivate,
+        // or when gWillDestroyEventWaitTime expires
+        static std::set<std::string> gWillDestroyPending;
+        static std::set<std::string> gWillDestroyCompleted;
+        static std::mutex gWillDestroyMutex;
+        static std::condition_variable gWillDestroyCondition;
+
+        static void completeWillDestroy(const std::string& callsign)
+        {
+            std::lock_guard<std::mutex> lock(gWillDestroyMutex);
+            if (gWillDestroyPending.find(callsign) != gWillDestroyPending.end())
+            {
+                gWillDestroyCompleted.insert(callsign);
+                gWillDestroyCondition.notify_all();
+            }
+        }
+
+        // controller status cache, loaded once from the controller and kept current by
+        // MonitorClients::StateChange so that api calls do not need a controller round trip
+        struct PluginStatusData
+        {
+            std::string mClassName;
+            std::string mClientIdentifier;
+            std::string mConfigLine;
+            bool mHasClientIdentifier;
+            PluginHost::IShell::state mState;
+        };
+
+        static std::map<std::string, PluginStatusData> gPluginStatus;
+        static std::mutex gPluginStatusMutex;
+        static bool gPluginStatusLoaded = false;
+
+        static std::map<std::string, std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> > > gThunderClients;
+        static std::mutex gThunderClientsMutex;
+
+        static void setPluginStatusConfig(PluginStatusData& statusData, const std::string& configLine)
+        {
+            statusData.mConfigLine = configLine;
+            statusData.mHasClientIdentifier = false;
+            statusData.mClientIdentifier.clear();
+            if (!configLine.empty())
+            {
+                JsonObject serviceConfig = JsonObject(configLine.c_str());
+                if (serviceConfig.HasLabel("clientidentifier"))
+                {
+                    statusData.mHasClientIdentifier = true;
+                    statusData.mClientIdentifier = serviceConfig["clientidentifier"].String();
+                }
+            }
+        }
+
+        static bool isPluginStatusActive(const PluginStatusData& statusData)
+        {
+            return (statusData.mState != PluginHost::IShell::DEACTIVATED &&
+                    statusData.mState != PluginHost::IShell::DEACTIVATION &&
+                    statusData.mState != PluginHost::IShell::PRECONDITION);
+        }
+
+        // replaces the cache with the current controller status
+        static bool loadPluginStatus(PluginHost::IShell* service)
+        {
+            Core::JSON::ArrayType<PluginHost::MetaData::Service> availablePluginResult;
+            JSONRPCDirectLink thunderController(service);
+            uint32_t status = thunderController.Get<Core::JSON::ArrayType<PluginHost::MetaData::Service>>(RDKSHELL_THUNDER_TIMEOUT, "status", availablePluginResult);
+            if (status > 0)
+            {
+                std::cout << "trying status one more time...\n";
+                status = thunderController.Get<Core::JSON::ArrayType<PluginHost::MetaData::Service>>(RDKSHELL_THUNDER_TIMEOUT, "status", availablePluginResult);
+            }
+            if (status > 0)
+            {
+                std::cout << "unable to load plugin status: " << status << std::endl;
+                return false;
+            }
+
+            std::map<std::string, PluginStatusData> pluginStatus;
+            for (uint16_t i = 0; i < availablePluginResult.Length(); i++)
+            {
+                PluginHost::MetaData::Service pluginService = availablePluginResult[i];
+                if (pluginService.JSONState == PluginHost::MetaData::Service::state::DESTROYED)
+                {
+                    continue;
+                }
+                std::string callsign = pluginService.Callsign.Value();
+                callsign.erase(std::remove(callsign.begin(),callsign.end(),'\"'),callsign.end());
+                if (callsign.empty())
+                {
+                    continue;
+                }
+                PluginStatusData statusData;
+                statusData.mClassName = pluginService.ClassName.Value();
+                std::string configLine;
+                pluginService.Configuration.ToString(configLine);
+                setPluginStatusConfig(statusData, configLine);
+                if (pluginService.JSONState == PluginHost::MetaData::Service::state::DEACTIVATED)
+                {
+                    statusData.mState = PluginHost::IShell::DEACTIVATED;
+                }
+                else if (pluginService.JSONState == PluginHost::MetaData::Service::state::DEACTIVATION)
+                {
+                    statusData.mState = PluginHost::IShell::DEACTIVATION;
+                }
+                else if (pluginService.JSONState == PluginHost::MetaData::Service::state::ACTIVATION)
+                {
+                    statusData.mState = PluginHost::IShell::ACTIVATION;
+                }
+                else if (pluginService.JSONState == PluginHost::MetaData::Service::state::PRECONDITION)
+                {
+                    statusData.mState = PluginHost::IShell::PRECONDITION;
+                }
+                else
+                {
+                    statusData.mState = PluginHost::IShell::ACTIVATED;
+                }
+                pluginStatus[callsign] = statusData;
+            }
+
+            std::lock_guard<std::mutex> lock(gPluginStatusMutex);
+            gPluginStatus.swap(pluginStatus);
+            gPluginStatusLoaded = true;
+            return true;
+        }
+
+        static void updatePluginStatus(PluginHost::IShell* service)
+        {
+            std::string callsign = service->Callsign();
+            PluginHost::IShell::state currentState(service->State());
+            std::lock_guard<std::mutex> lock(gPluginStatusMutex);
+            if (currentState == PluginHost::IShell::DESTROYED)
+            {
+                gPluginStatus.erase(callsign);
+                return;
+            }
+            auto statusEntry = gPluginStatus.find(callsign);
+            if (statusEntry == gPluginStatus.end())
+            {
+                PluginStatusData statusData;
+                statusData.mClassName = service->ClassName();
+                setPluginStatusConfig(statusData, service->ConfigLine());
+                statusEntry = gPluginStatus.insert(std::make_pair(callsign, statusData)).first;
+            }
+            else if (currentState == PluginHost::IShell::ACTIVATION)
+            {
+                // configuration can be changed between activations
+                setPluginStatusConfig(statusEntry->second, service->ConfigLine());
+            }
+            statusEntry->second.mState = currentState;
+        }
+
+        // returns a copy of the cached plugin status, loading it from the controller if needed
+        static bool getPluginStatus(PluginHost::IShell* service, std::map<std::string, PluginStatusData>& pluginStatus)
+        {
+            bool loaded = false;
+            {
+                std::lock_guard<std::mutex> lock(gPluginStatusMutex);
+                loaded = gPluginStatusLoaded;
+            }
+            if (!loaded && !loadPluginStatus(service))
+            {
+                return false;
+            }
+            std::lock_guard<std::mutex> lock(gPluginStatusMutex);
+            pluginStatus = gPluginStatus;
+            return true;
+        }
+
+        static bool findPluginStatus(PluginHost::IShell* service, const std::string& callsign, PluginStatusData& statusData)
+        {
+            bool loaded = false;
+            {
+                std::lock_guard<std::mutex> lock(gPluginStatusMutex);
+                loaded = gPluginStatusLoaded;
+                auto statusEntry = gPluginStatus.find(callsign);
+                if (statusEntry != gPluginStatus.end())
+                {
+                    statusData = statusEntry->second;
+                    return true;
+                }
+            }
+            if (!loaded && loadPluginStatus(service))
+            {
+                std::lock_guard<std::mutex> lock(gPluginStatusMutex);
+                auto statusEntry = gPluginStatus.find(callsign);
+                if (statusEntry != gPluginStatus.end())
+                {
+                    statusData = statusEntry->second;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        static void updatePluginConfigLine(const std::string& callsign, const std::string& configLine)
+        {
+            std::lock_guard<std::mutex> lock(gPluginStatusMutex);
+            auto statusEntry = gPluginStatus.find(callsign);
+            if (statusEntry != gPluginStatus.end())
+            {
+                setPluginStatusConfig(statusEntry->second, configLine);
+            }
+        }
+
+        // pooled links are keyed by "callsign.version", drop all versions of a plugin that went away
+        static void releaseThunderClients(const std::string& callsign)
+        {
+            std::lock_guard<std::mutex> lock(gThunderClientsMutex);
+            for (auto clientEntry = gThunderClients.begin(); clientEntry != gThunderClients.end();)
+            {
+                const std::string& name = clientEntry->first;
+                if (name.compare(0, callsign.length() + 1, callsign + ".") == 0)
+                {
+                    clientEntry = gThunderClients.erase(clientEntry);
+                }
+                else
+                {
+                    clientEntry++;
+                }
+            }
+        }
+
+        uint32_t getKeyFlag(std::string modifier)
+        {
+          uint32_t flag = 0;
+          if (0 == modifier.compare("ctrl"))
+          {
+            flag = RDKSHELL_FLAGS_CONTROL;
+          }
+          else if (0 == modifier.compare("shift"))
+          {
+            flag = RDKSHELL_FLAGS_SHIFT;
+          }
+          else if (0 == modifier.compare("alt"))
+          {
+            flag = RDKSHELL_FLAGS_ALT;
+          }
+          return flag;
+        }
+
+        // key sequences of an async generateKey request, injected by gKeySequenceThread at their offsets
+        struct ScheduledKey
+        {
+            std::string client;
+            uint32_t keyCode;
+            uint32_t flags;
+            uint64_t offsetInMs;
+        };
+
+        struct KeySequence
+        {
+            std::vector<ScheduledKey> keys;
+            size_t nextKey;
+            uint32_t failedKeys;
+            std::chrono::steady_clock::time_point startTime;
+        };
+
+        static std::map<uint32_t, KeySequence> gKeySequences;
+        static std::mutex gKeySequenceMutex;
+        static std::condition_variable gKeySequenceCondition;
+        static std::thread gKeySequenceThread;
+        static bool gKeySequenceThreadRunning = false;
+        static uint32_t gNextKeySequenceId = 1;
+
+        // "delayMs" takes precedence over "delay" (seconds); both are relative to the previous key
+        static void parseKeyInputs(const std::string& client, const JsonArray& keyInputs, std::vector<ScheduledKey>& keys)
+        {
+            uint64_t offsetInMs = 0;
+            for (int i=0; i<keyInputs.Length(); i++) {
+                const JsonObject& keyInputInfo = keyInputs[i].Object();
+                if (keyInputInfo.HasLabel("keyCode"))
+                {
+                  ScheduledKey key;
+                  key.keyCode = keyInputInfo["keyCode"].Number();
+                  offsetInMs += keyInputInfo.HasLabel("delayMs") ? keyInputInfo["delayMs"].Number() : (keyInputInfo["delay"].Number() * 1000);
+                  key.offsetInMs = offsetInMs;
+                  const JsonArray modifiers = keyInputInfo.HasLabel("modifiers") ? keyInputInfo["modifiers"].Array() : JsonArray();
+                  key.client = keyInputInfo.HasLabel("client")? keyInputInfo["client"].String(): client;
+                  if (key.client.empty())
+                  {
+                    key.client = keyInputInfo.HasLabel("callsign")? keyInputInfo["callsign"].String(): "";
+                  }
+                  key.flags = 0;
+                  for (int k=0; k<modifiers.Length(); k++) {
+                    key.flags |= getKeyFlag(modifiers[k].String());
+                  }
+                  keys.push_back(key);
+                }
+            }
+        }
+
+        SERVICE_REGISTRATION(RDKShell, 1, 0);
+
+        RDKShell* RDKShell::_instance = nullptr;
+        std::recursive_mutex gRdkShellMutex;
+        std::mutex gPluginDataMutex;
+        std::mutex gLaunchDestroyMutex;
+
+        std::mutex gLaunchMutex;
+        int32_t gLaunchCount = 0;
+
+        static std::thread shellThread;
+
+        struct ScreenshotRequest
+        {
+            std::string format;
+            uint32_t width;
+            uint32_t height;
+        };
+
+        struct ScreenshotJob
+        {
+            ScreenshotRequest request;
+            std::shared_ptr<uint8_t> data;
+            size_t size;
+            uint32_t width;
+            uint32_t height;
+        };
+
+        // requests are queued by getScreenshot and consumed by the render thread (under gRdkShellMutex),
+        // the captured frames are then encoded and notified from the screenshot thread
+        static std::vector<ScreenshotRequest> gScreenshotRequests;
+        static std::thread gScreenshotThread;
+        static std::mutex gScreenshotMutex;
+        static std::condition_variable gScreenshotCondition;
+        static std::list<ScreenshotJob> gScreenshotJobs;
+        static bool gScreenshotThreadRunning = false;
+
+        bool isScreenshotFormatSupported(const std::string& format)
+        {
+            if (format == "raw")
+            {
+                return true;
+            }
+#ifdef RDKSHELL_SCREENSHOT_PNG
+            if (format == "png")
+            {
+                return true;
+            }
+#endif
+#ifdef RDKSHELL_SCREENSHOT_JPEG
+            if (format == "jpeg")
+            {
+                return true;
+            }
+#endif
+            return false;
+        }
+
+        // box filter downscale of an rgba image, every destination pixel is the average of the source pixels it covers
+        void scaleScreenshot(const uint8_t* source, uint32_t sourceWidth, uint32_t sourceHeight, std::vector<uint8_t>& destination, uint32_t width, uint32_t height)
+        {
+            destination.resize((size_t)width * height * 4);
+            for (uint32_t y = 0; y < height; y++)
+            {
+                uint32_t y0 = (uint64_t)y * sourceHeight / height;
+                uint32_t y1 = std::max(y0 + 1, (uint32_t)((uint64_t)(y + 1) * sourceHeight / height));
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    uint32_t x0 = (uint64_t)x * sourceWidth / width;
+                    uint32_t x1 = std::max(x0 + 1, (uint32_t)((uint64_t)(x + 1) * sourceWidth / width));
+                    uint32_t sum[4] = { 0, 0, 0, 0 };
+                    for (uint32_t sy = y0; sy < y1; sy++)
+                    {
+                        const uint8_t* pixel = source + ((size_t)sy * sourceWidth + x0) * 4;
+                        for (uint32_t sx = x0; sx < x1; sx++, pixel += 4)
+                        {
+                            sum[0] += pixel[0];
+                            sum[1] += pixel[1];
+                            sum[2] += pixel[2];
+                            sum[3] += pixel[3];
+                        }
+                    }
+                    uint32_t count = (y1 - y0) * (x1 - x0);
+                    uint8_t* out = &destination[((size_t)y * width + x) * 4];
+                    out[0] = sum[0] / count;
+                    out[1] = sum[1] / count;
+                    out[2] = sum[2] / count;
+                    out[3] = sum[3] / count;
+                }
+            }
+        }
+
+#ifdef RDKSHELL_SCREENSHOT_PNG
+        static void screenshotPngWrite(png_structp pngPtr, png_bytep data, png_size_t length)
+        {
+            std::vector<uint8_t>* output = (std::vector<uint8_t>*)png_get_io_ptr(pngPtr);
+            output->insert(output->end(), data, data + length);
+        }
+
+        bool encodeScreenshotPng(const std::vector<const uint8_t*>& rows, uint32_t width, std::vector<uint8_t>& output)
+        {
+            png_structp pngPtr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+            if (NULL == pngPtr)
+            {
+                return false;
+            }
+            png_infop infoPtr = png_create_info_struct(pngPtr);
+            if (NULL == infoPtr || setjmp(png_jmpbuf(pngPtr)))
+            {
+                png_destroy_write_struct(&pngPtr, &infoPtr);
+                return false;
+            }
+            png_set_IHDR(pngPtr, infoPtr, width, rows.size(), 8, PNG_COLOR_TYPE_RGBA, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
+            png_set_write_fn(pngPtr, &output, screenshotPngWrite, NULL);
+            png_set_rows(pngPtr, infoPtr, (png_bytepp)&rows[0]);
+            png_write_png(pngPtr, infoPtr, PNG_TRANSFORM_IDENTITY, NULL);
+            png_destroy_write_struct(&pngPtr, &infoPtr);
+            return true;
+        }
+#endif
+
+#ifdef RDKSHELL_SCREENSHOT_JPEG
+        // the default libjpeg error handler exit()s the process, jump back to the encoder instead
+        struct ScreenshotJpegError
+        {
+            struct jpeg_error_mgr manager;
+            jmp_buf jump;
+        };
+
+        static void screenshotJpegErrorExit(j_common_ptr cinfo)
+        {
+            char message[JMSG_LENGTH_MAX];
+            (*cinfo->err->format_message)(cinfo, message);
+            std::cout << "jpeg encoding failed: " << message << std::endl;
+            longjmp(((ScreenshotJpegError*)cinfo->err)->jump, 1);
+        }
+
+        bool encodeScreenshotJpeg(const std::vector<const uint8_t*>& rows, uint32_t width, std::vector<uint8_t>& output)
+        {
+            struct jpeg_compress_struct cinfo;
+            ScreenshotJpegError jerr;
+            unsigned char* buffer = NULL;
+            unsigned long bufferSize = 0;
+            std::vector<uint8_t> line(width * 3);
+
+            cinfo.err = jpeg_std_error(&jerr.manager);
+            jerr.manager.error_exit = screenshotJpegErrorExit;
+            if (setjmp(jerr.jump))
+            {
+                jpeg_destroy_compress(&cinfo);
+                free(buffer);
+                return false;
+            }
+            jpeg_create_compress(&cinfo);
+            jpeg_mem_dest(&cinfo, &buffer, &bufferSize);
+            cinfo.image_width = width;
+            cinfo.image_height = rows.size();
+            cinfo.input_components = 3;
+            cinfo.in_color_space = JCS_RGB;
+            jpeg_set_defaults(&cinfo);
+            jpeg_set_quality(&cinfo, RDKSHELL_SCREENSHOT_JPEG_QUALITY, TRUE);
+            jpeg_start_compress(&cinfo, TRUE);
+            while (cinfo.next_scanline < cinfo.image_height)
+            {
+                const uint8_t* row = rows[cinfo.next_scanline];
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    line[x * 3] = row[x * 4];
+                    line[x * 3 + 1] = row[x * 4 + 1];
+                    line[x * 3 + 2] = row[x * 4 + 2];
+                }
+                JSAMPROW rowPointer = &line[0];
+                jpeg_write_scanlines(&cinfo, &rowPointer, 1);
+            }
+            jpeg_finish_compress(&cinfo);
+            jpeg_destroy_compress(&cinfo);
+            output.assign(buffer, buffer + bufferSize);
+            free(buffer);
+            return true;
+        }
+#endif
+
+        // runs on the screenshot thread. raw output keeps the bottom up row order of the compositor
+        // read back, encoded formats are written top down
+        bool processScreenshotJob(const ScreenshotJob& job, JsonObject& params)
+        {
+            const uint8_t* pixels = job.data.get();
+            uint32_t width = job.width;
+            uint32_t height = job.height;
+            size_t size = job.size;
+            bool scale = (job.request.width > 0 || job.request.height > 0);
+            bool encode = (job.request.format != "raw");
+            std::vector<uint8_t> scaled;
+            std::vector<uint8_t> encoded;
+
+            if ((scale || encode) && (0 == width || 0 == height || (size_t)width * height * 4 != size))
+            {
+                std::cout << "screenshot size " << size << " does not match resolution " << width << "x" << height << std::endl;
+                return false;
+            }
+            if (scale)
+            {
+                uint32_t targetWidth = job.request.width;
+                uint32_t targetHeight = job.request.height;
+                if (0 == targetWidth)
+                {
+                    targetWidth = std::max((uint64_t)1, (uint64_t)width * targetHeight / height);
+                }
+                if (0 == targetHeight)
+                {
+                    targetHeight = std::max((uint64_t)1, (uint64_t)height * targetWidth / width);
+                }
+                if (targetWidth < width || targetHeight < height)
+                {
+                    targetWidth = std::min(targetWidth, width);
+                    targetHeight = std::min(targetHeight, height);
+                    scaleScreenshot(pixels, width, height, scaled, targetWidth, targetHeight);
+                    pixels = &scaled[0];
+                    width = targetWidth;
+                    height = targetHeight;
+                    size = scaled.size();
+                }
+            }
+            if (encode)
+            {
+                std::vector<const uint8_t*> rows(height);
+                for (uint32_t y = 0; y < height; y++)
+                {
+                    rows[y] = pixels + (size_t)(height - 1 - y) * width * 4;
+                }
+                bool encodeResult = false;
+#ifdef RDKSHELL_SCREENSHOT_PNG
+                if (job.request.format == "png")
+                {
+                    encodeResult = encodeScreenshotPng(rows, width, encoded);
+                }
+#endif
+#ifdef RDKSHELL_SCREENSHOT_JPEG
+                if (job.request.format == "jpeg")
+                {
+                    encodeResult = encodeScreenshotJpeg(rows, width, encoded);
+                }
+#endif
+                if (!encodeResult || encoded.empty())
+                {
+                    std::cout << "unable to encode screenshot as " << job.request.format << std::endl;
+                    return false;
+                }
+                pixels = &encoded[0];
+                size = encoded.size();
+            }
+
+            std::string imageData;
+            imageData.resize(b64_get_encoded_buffer_size(size));
+            b64_encode(pixels, size, (uint8_t*)&imageData[0]);
+            std::cout << "Screenshot success size:" << size << std::endl;
+            params["imageData"] = imageData;
+            params["format"] = job.request.format;
+            params["width"] = width;
+            params["height"] = height;
+            return true;
+        }
+
+        void RDKShell::launchRequestThread(RDKShellApiRequest apiRequest)
+        {
+	    std::thread rdkshellRequestsThread = std::thread([=]() {
+                if (apiRequest.mName.compare("launchfactoryapp") == 0)
+                {
+                    JsonObject result;
+                    launchFactoryAppWrapper(apiRequest.mRequest, result);
+                }
+		else if (apiRequest.mName.compare("deactivateresidentapp") == 0)
+                {
+                    auto thunderController = std::unique_ptr<JSONRPCDirectLink>(new JSONRPCDirectLink(mCurrentService));
+                    JsonObject deactivateParams;
+                    deactivateParams.Set("callsign", "ResidentApp");
+                    JsonObject deactivateResult;
+                    int32_t deactivateStatus = thunderController->Invoke(0, "deactivate", deactivateParams, deactivateResult);
+                    std::cout << "deactivating resident app status " << deactivateStatus << std::endl;
+                }
+            });
+            rdkshellRequestsThread.detach();
+        }
+
+        // timing histograms in microseconds. buckets are cumulative counters updated with relaxed atomics so
+        // that recording a sample costs a couple of increments on the render thread and api threads
+        static const uint32_t gFrameStatsBucketLimits[RDKSHELL_FRAME_STATS_BUCKETS - 1] = { 250, 500, 1000, 2000, 4000, 8000, 16000, 33000, 66000, 133000, 266000 };
+
+        struct RdkShellHistogram
+        {
+            std::atomic<uint64_t> buckets[RDKSHELL_FRAME_STATS_BUCKETS];
+            std::atomic<uint64_t> count;
+            std::atomic<uint64_t> total;
+            std::atomic<uint64_t> max;
+        };
+
+        static RdkShellHistogram gFrameTimeStats;
+        static RdkShellHistogram gLockWaitStats;
+        static RdkShellHistogram gLockHoldStats;
+        static std::atomic<uint64_t> gMissedFrames(0);
+        static std::atomic<uint32_t> gFrameStatsInterval(0);
+
+        static void addHistogramSample(RdkShellHistogram& histogram, double time)
+        {
+            uint64_t sample = (time > 0) ? (uint64_t)time : 0;
+            uint32_t bucket = 0;
+            while (bucket < RDKSHELL_FRAME_STATS_BUCKETS - 1 && sample > gFrameStatsBucketLimits[bucket])
+            {
+                bucket++;
+            }
+            histogram.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+            histogram.count.fetch_add(1, std::memory_order_relaxed);
+            histogram.total.fetch_add(sample, std::memory_order_relaxed);
+            uint64_t max = histogram.max.load(std::memory_order_relaxed);
+            while (sample > max && !histogram.max.compare_exchange_weak(max, sample, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        static void resetHistogram(RdkShellHistogram& histogram)
+        {
+            for (uint32_t i = 0; i < RDKSHELL_FRAME_STATS_BUCKETS; i++)
+            {
+                histogram.buckets[i] = 0;
+            }
+            histogram.count = 0;
+            histogram.total = 0;
+            histogram.max = 0;
+        }
+
+        // percentiles are reported as the upper limit of the bucket they fall in
+        static void getHistogram(const RdkShellHistogram& histogram, JsonObject& stats)
+        {
+            uint64_t buckets[RDKSHELL_FRAME_STATS_BUCKETS];
+            uint64_t count = 0;
+            for (uint32_t i = 0; i < RDKSHELL_FRAME_STATS_BUCKETS; i++)
+            {
+                buckets[i] = histogram.buckets[i].load(std::memory_order_relaxed);
+                count += buckets[i];
+            }
+            uint64_t max = histogram.max.load(std::memory_order_relaxed);
+            uint64_t total = histogram.total.load(std::memory_order_relaxed);
+            const double percentiles[] = { 0.5, 0.95, 0.99 };
+            const char* percentileNames[] = { "p50", "p95", "p99" };
+            for (uint32_t p = 0; p < 3; p++)
+            {
+                uint64_t rank = (uint64_t)(percentiles[p] * count);
+                uint64_t seen = 0;
+                uint64_t value = 0;
+                for (uint32_t i = 0; i < RDKSHELL_FRAME_STATS_BUCKETS && count > 0; i++)
+                {
+                    seen += buckets[i];
+                    if (seen > rank || i == RDKSHELL_FRAME_STATS_BUCKETS - 1)
+                    {
+                        value = (i < RDKSHELL_FRAME_STATS_BUCKETS - 1) ? std::min((uint64_t)gFrameStatsBucketLimits[i], max) : max;
+                        break;
+                    }
+                }
+                stats[percentileNames[p]] = value;
+            }
+            JsonArray bucketCounts;
+            for (uint32_t i = 0; i < RDKSHELL_FRAME_STATS_BUCKETS; i++)
+            {
+                bucketCounts.Add(buckets[i]);
+            }
+            stats["count"] = count;
+            stats["average"] = (count > 0) ? (total / count) : 0;
+            stats["max"] = max;
+            stats["buckets"] = bucketCounts;
+        }
+
+        static void getFrameStats(JsonObject& stats)
+        {
+            JsonArray bucketLimits;
+            for (uint32_t i = 0; i < RDKSHELL_FRAME_STATS_BUCKETS - 1; i++)
+            {
+                bucketLimits.Add(gFrameStatsBucketLimits[i]);
+            }
+            JsonObject frameTime, lockWait, lockHold;
+            getHistogram(gFrameTimeStats, frameTime);
+            getHistogram(gLockWaitStats, lockWait);
+            getHistogram(gLockHoldStats, lockHold);
+            stats["framerate"] = gCurrentFramerate;
+            stats["missedFrames"] = gMissedFrames.load();
+            stats["bucketLimits"] = bucketLimits;
+            stats["frameTime"] = frameTime;
+            stats["lockWait"] = lockWait;
+            stats["lockHold"] = lockHold;
+        }
+
+        static void resetFrameStats()
+        {
+            resetHistogram(gFrameTimeStats);
+            resetHistogram(gLockWaitStats);
+            resetHistogram(gLockHoldStats);
+            gMissedFrames = 0;
+        }
+
+        static void invalidateRdkShellSnapshot();
+
+        static std::thread::id gRenderThreadId;
+        // gRdkShellMutex is recursive, api threads record wait and hold times for their outermost lock only.
+        // the render thread records its own per frame
+        static thread_local uint32_t gRdkShellLockDepth = 0;
+        static thread_local double gRdkShellLockedTime = 0;
+
+        // for callers that only read compositor state, the published snapshot stays valid
+        void lockRdkShellMutexForRead()
+        {
+            double startTime = RdkShell::microseconds();
+            gRdkShellMutex.lock();
+            if (gRdkShellLockDepth++ == 0 && std::this_thread::get_id() != gRenderThreadId)
+            {
+                gRdkShellLockedTime = RdkShell::microseconds();
+                addHistogramSample(gLockWaitStats, gRdkShellLockedTime - startTime);
+            }
+        }
+
+        // callers may change compositor state directly under the lock, so the published snapshot is dropped
+        // until the render thread republishes it and reads fall back to the compositor in the meantime
+        void lockRdkShellMutex()
+        {
+            lockRdkShellMutexForRead();
+            invalidateRdkShellSnapshot();
+        }
+
+        void unlockRdkShellMutex()
+        {
+            if (--gRdkShellLockDepth == 0 && std::this_thread::get_id() != gRenderThreadId)
+            {
+                addHistogramSample(gLockHoldStats, RdkShell::microseconds() - gRdkShellLockedTime);
+            }
+            gRdkShellMutex.unlock();
+        }
+
+        // compositor changes requested by api threads are queued and applied by the render thread at the start
+        // of the next frame. the queue is an intrusive multi producer single consumer list, producers only swap
+        // the tail and the render thread is the only consumer
+        enum RdkShellCommandState
+        {
+            RDKSHELL_COMMAND_PENDING,
+            RDKSHELL_COMMAND_RUNNING,
+            RDKSHELL_COMMAND_CANCELLED
+        };
+
+        // a command is owned by the caller and the queue, whichever releases it last deletes it. a caller that
+        // gives up waiting cancels the command so that the render thread does not run it after the caller returned
+        struct RdkShellCommand
+        {
+            RdkShellCommand()
+                : state(RDKSHELL_COMMAND_PENDING)
+                , references(2)
+                , next(nullptr)
+            {
+            }
+
+            std::function<bool()> function;
+            std::promise<bool> result;
+            std::atomic<int> state;
+            std::atomic<int> references;
+            std::atomic<RdkShellCommand*> next;
+        };
+
+        static void releaseRdkShellCommand(RdkShellCommand* command)
+        {
+            if (command->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                delete command;
+            }
+        }
+
+        static RdkShellCommand gCommandStub;
+        static std::atomic<RdkShellCommand*> gCommandTail(&gCommandStub);
+        static RdkShellCommand* gCommandHead = &gCommandStub;
+        static std::atomic<bool> gCommandQueueActive(false);
+        static std::atomic<int32_t> gCommandProducers(0);
+
+        struct BoundsFence
+        {
+            uint64_t fence;
+            std::string client;
+            unsigned int x;
+            unsigned int y;
+            unsigned int width;
+            unsigned int height;
+        };
+
+        // number of frames drawn by the render thread. a change made under gRdkShellMutex is on screen
+        // once the count reaches the fence taken while making it
+        static std::mutex gFrameFenceMutex;
+        static std::condition_variable gFrameFenceCondition;
+        static uint64_t gPresentedFrames = 0;
+        static std::vector<BoundsFence> gBoundsFences;
+
+        // must be called with gRdkShellMutex held, in the same critical section as the change
+        static uint64_t getRdkShellFrameFence()
+        {
+            std::lock_guard<std::mutex> lock(gFrameFenceMutex);
+            return gPresentedFrames + 1;
+        }
+
+        static bool waitForRdkShellFrameFence(uint64_t fence)
+        {
+            if (std::this_thread::get_id() == gRenderThreadId)
+            {
+                return false;
+            }
+            std::unique_lock<std::mutex> lock(gFrameFenceMutex);
+            return gFrameFenceCondition.wait_for(lock, std::chrono::milliseconds(RDKSHELL_FRAME_FENCE_TIMEOUT_IN_MS), [fence]{ return gPresentedFrames >= fence; });
+        }
+
+        static void addBoundsFence(const BoundsFence& boundsFence)
+        {
+            std::lock_guard<std::mutex> lock(gFrameFenceMutex);
+            gBoundsFences.push_back(boundsFence);
+        }
+
+        // called by the render thread after each frame, before it releases gRdkShellMutex
+        static void signalRdkShellFrameFence(std::vector<BoundsFence>& appliedBounds)
+        {
+            std::lock_guard<std::mutex> lock(gFrameFenceMutex);
+            gPresentedFrames++;
+            for (auto boundsFence = gBoundsFences.begin(); boundsFence != gBoundsFences.end();)
+            {
+                if (boundsFence->fence <= gPresentedFrames)
+                {
+                    appliedBounds.push_back(*boundsFence);
+                    boundsFence = gBoundsFences.erase(boundsFence);
+                }
+                else
+                {
+                    boundsFence++;
+                }
+            }
+            gFrameFenceCondition.notify_all();
+        }
+
+        struct RdkShellClientSnapshot
+        {
+            bool hasBounds;
+            unsigned int x, y, width, height;
+            bool hasVisibility;
+            bool visible;
+            bool hasOpacity;
+            unsigned int opacity;
+            bool hasScale;
+            double scaleX, scaleY;
+            bool hasHolePunch;
+            bool holePunch;
+        };
 
-          BEGIN_INTERFACE_MAP(Notification)
-          INTERFACE_ENTRY(PluginHost::IStateControl::INotification)
-          END_INTERFACE_MAP
+        // compositor state published by the render thread once per frame for the read only apis
+        struct RdkShellSnapshot
+        {
+            std::vector<std::string> clients;
+            std::vector<std::string> zOrder;
+            std::map<std::string, RdkShellClientSnapshot> clientState;
         };
 
-        std::map<std::string, StateControlNotification*> gStateNotifications;
+        static std::shared_ptr<const RdkShellSnapshot> gRdkShellSnapshot;
 
-        struct RDKShellStartupConfig
+        // the snapshot is only rebuilt when a command or direct change may have altered the compositor, while
+        // an animation is running (plus one refresh interval to catch its final frame) and otherwise every
+        // RDKSHELL_SNAPSHOT_REFRESH_INTERVAL_IN_MS so that clients connecting outside of rdkshell show up in
+        // getClients/getZOrder. guarded by gRdkShellMutex
+        static bool gRdkShellSnapshotDirty = true;
+        static double gRdkShellSnapshotTime = 0;
+        static double gRdkShellAnimationUntil = 0;
+
+        static void invalidateRdkShellSnapshot()
         {
-            std::string rfc;
-            std::string thunderApi;
-            JsonObject params;
-        };
+            if (!gRdkShellSnapshotDirty)
+            {
+                gRdkShellSnapshotDirty = true;
+                std::atomic_store(&gRdkShellSnapshot, std::shared_ptr<const RdkShellSnapshot>());
+            }
+        }
 
-        std::map<std::string, PluginData> gActivePluginsData;
-        std::map<std::string, PluginStateChangeData*> gPluginsEventListener;
-        std::vector<RDKShellStartupConfig> gStartupConfigs;
-        std::map<std::string, bool> gDestroyApplications;
-        std::map<std::string, bool> gLaunchApplications;
-        
-        uint32_t getKeyFlag(std::string modifier)
+        static void pushRdkShellCommand(RdkShellCommand* command)
         {
-          uint32_t flag = 0;
-          if (0 == modifier.compare("ctrl"))
-          {
-            flag = RDKSHELL_FLAGS_CONTROL;
-          }
-          else if (0 == modifier.compare("shift"))
-          {
-            flag = RDKSHELL_FLAGS_SHIFT;
-          }
-          else if (0 == modifier.compare("alt"))
-          {
-            flag = RDKSHELL_FLAGS_ALT;
-          }
-          return flag;
+            command->next.store(nullptr, std::memory_order_relaxed);
+            RdkShellCommand* previous = gCommandTail.exchange(command, std::memory_order_acq_rel);
+            previous->next.store(command, std::memory_order_release);
         }
 
-        SERVICE_REGISTRATION(RDKShell, 1, 0);
+        // returns nullptr when the queue is empty or a producer has not finished linking its command yet,
+        // in which case the command is picked up on the next frame
+        static RdkShellCommand* popRdkShellCommand()
+        {
+            RdkShellCommand* head = gCommandHead;
+            RdkShellCommand* next = head->next.load(std::memory_order_acquire);
+            if (head == &gCommandStub)
+            {
+                if (nullptr == next)
+                {
+                    return nullptr;
+                }
+                gCommandHead = next;
+                head = next;
+                next = next->next.load(std::memory_order_acquire);
+            }
+            if (nullptr != next)
+            {
+                gCommandHead = next;
+                return head;
+            }
+            if (head != gCommandTail.load(std::memory_order_acquire))
+            {
+                return nullptr;
+            }
+            pushRdkShellCommand(&gCommandStub);
+            next = head->next.load(std::memory_order_acquire);
+            if (nullptr != next)
+            {
+                gCommandHead = next;
+                return head;
+            }
+            return nullptr;
+        }
 
-        RDKShell* RDKShell::_instance = nullptr;
-        std::mutex gRdkShellMutex;
-        std::mutex gPluginDataMutex;
-        std::mutex gLaunchDestroyMutex;
+        static void publishRdkShellSnapshot()
+        {
+            const double now = RdkShell::milliseconds();
+            if (!gRdkShellSnapshotDirty && (now > gRdkShellAnimationUntil) && (now - gRdkShellSnapshotTime < RDKSHELL_SNAPSHOT_REFRESH_INTERVAL_IN_MS))
+            {
+                return;
+            }
+            gRdkShellSnapshotDirty = false;
+            gRdkShellSnapshotTime = now;
+            std::shared_ptr<RdkShellSnapshot> snapshot = std::make_shared<RdkShellSnapshot>();
+            CompositorController::getClients(snapshot->clients);
+            CompositorController::getZOrder(snapshot->zOrder);
+            for (size_t i = 0; i < snapshot->clients.size(); i++)
+            {
+                RdkShellClientSnapshot& state = snapshot->clientState[snapshot->clients[i]];
+                const std::string& client = snapshot->clients[i];
+                state.hasBounds = CompositorController::getBounds(client, state.x, state.y, state.width, state.height);
+                state.hasVisibility = CompositorController::getVisibility(client, state.visible);
+                state.hasOpacity = CompositorController::getOpacity(client, state.opacity);
+                state.hasScale = CompositorController::getScale(client, state.scaleX, state.scaleY);
+                state.hasHolePunch = CompositorController::getHolePunch(client, state.holePunch);
+            }
+            std::atomic_store(&gRdkShellSnapshot, std::shared_ptr<const RdkShellSnapshot>(snapshot));
+        }
 
-        std::mutex gLaunchMutex;
-        int32_t gLaunchCount = 0;
+        static std::shared_ptr<const RdkShellSnapshot> getRdkShellSnapshot()
+        {
+            return std::atomic_load(&gRdkShellSnapshot);
+        }
 
-        static std::thread shellThread;
+        // looks up a client in the published snapshot, returns nullptr when there is no snapshot yet or the
+        // client was created after it was taken so that the caller can fall back to the compositor
+        static const RdkShellClientSnapshot* findClientSnapshot(const std::shared_ptr<const RdkShellSnapshot>& snapshot, const std::string& client)
+        {
+            if (!snapshot)
+            {
+                return nullptr;
+            }
+            std::string clientName = client;
+            std::transform(clientName.begin(), clientName.end(), clientName.begin(), [](unsigned char c){ return std::tolower(c); });
+            std::map<std::string, RdkShellClientSnapshot>::const_iterator it = snapshot->clientState.find(clientName);
+            return (it != snapshot->clientState.end()) ? &it->second : nullptr;
+        }
 
-        void RDKShell::launchRequestThread(RDKShellApiRequest apiRequest)
+        // called by the render thread with gRdkShellMutex held. the snapshot is republished before the
+        // waiting callers are released so that a read following a change sees its result
+        static void applyRdkShellCommands()
         {
-	    std::thread rdkshellRequestsThread = std::thread([=]() {
-                if (apiRequest.mName.compare("launchfactoryapp") == 0)
+            std::vector<std::pair<RdkShellCommand*, bool> > applied;
+            RdkShellCommand* command = nullptr;
+            while (nullptr != (command = popRdkShellCommand()))
+            {
+                int state = RDKSHELL_COMMAND_PENDING;
+                if (!command->state.compare_exchange_strong(state, RDKSHELL_COMMAND_RUNNING))
                 {
-                    JsonObject result;
-                    launchFactoryAppWrapper(apiRequest.mRequest, result);
+                    releaseRdkShellCommand(command);
+                    continue;
                 }
-		else if (apiRequest.mName.compare("deactivateresidentapp") == 0)
+                bool result = false;
+                try
                 {
-                    auto thunderController = std::unique_ptr<JSONRPCDirectLink>(new JSONRPCDirectLink(mCurrentService));
-                    JsonObject deactivateParams;
-                    deactivateParams.Set("callsign", "ResidentApp");
-                    JsonObject deactivateResult;
-                    int32_t deactivateStatus = thunderController->Invoke(0, "deactivate", deactivateParams, deactivateResult);
-                    std::cout << "deactivating resident app status " << deactivateStatus << std::endl;
+                    result = command->function();
                 }
-            });
-            rdkshellRequestsThread.detach();
+                catch (...)
+                {
+                    std::cout << "rdkshell command failed with an exception\n";
+                }
+                applied.push_back(std::make_pair(command, result));
+            }
+            if (!applied.empty())
+            {
+                gRdkShellSnapshotDirty = true;
+            }
+            publishRdkShellSnapshot();
+            for (size_t i = 0; i < applied.size(); i++)
+            {
+                applied[i].first->result.set_value(applied[i].second);
+                releaseRdkShellCommand(applied[i].first);
+            }
         }
 
-        void lockRdkShellMutex()
+        // the render thread releases gRdkShellMutex around blocking calls that may end up in other rdkshell apis
+        // (easter egg actions, factory app launch). commands are applied directly by their callers while it is
+        // away, otherwise those callers would wait for a frame that cannot start
+        static void suspendRdkShellCommands()
         {
-            bool lockAcquired = false;
-            double startTime = RdkShell::milliseconds();
-            while (!lockAcquired && (RdkShell::milliseconds() - startTime) < RDKSHELL_TRY_LOCK_WAIT_TIME_IN_MS)
+            if (std::this_thread::get_id() != gRenderThreadId || !gCommandQueueActive)
             {
-                lockAcquired = gRdkShellMutex.try_lock();
+                return;
             }
-            if (!lockAcquired)
+            gCommandQueueActive = false;
+            while (gCommandProducers > 0)
             {
-                std::cout << "unable to get lock for defaulting to normal lock\n";
-                gRdkShellMutex.lock();
+                std::this_thread::yield();
+            }
+            applyRdkShellCommands();
+        }
+
+        static void resumeRdkShellCommands()
+        {
+            if (std::this_thread::get_id() == gRenderThreadId && sRunning)
+            {
+                gCommandQueueActive = true;
             }
-            /*else
+        }
+
+        // runs a compositor change on the render thread and waits for its result. before the render loop is
+        // running, after it stopped and when called from the render thread itself the change is applied directly.
+        // fails without applying the change if the render thread does not pick it up within RDKSHELL_THUNDER_TIMEOUT
+        bool runRdkShellCommand(const std::function<bool()>& function)
+        {
+            gCommandProducers++;
+            if (!gCommandQueueActive || (std::this_thread::get_id() == gRenderThreadId))
             {
-                std::cout << "lock was acquired via try\n";
-            }*/
+                gCommandProducers--;
+                lockRdkShellMutex();
+                bool result = function();
+                unlockRdkShellMutex();
+                return result;
+            }
+            double startTime = RdkShell::microseconds();
+            RdkShellCommand* command = new RdkShellCommand();
+            command->function = function;
+            std::future<bool> result = command->result.get_future();
+            pushRdkShellCommand(command);
+            gCommandProducers--;
+            bool applied = false;
+            if (result.wait_for(std::chrono::milliseconds(RDKSHELL_THUNDER_TIMEOUT)) == std::future_status::ready)
+            {
+                applied = result.get();
+            }
+            else
+            {
+                int state = RDKSHELL_COMMAND_PENDING;
+                if (command->state.compare_exchange_strong(state, RDKSHELL_COMMAND_CANCELLED))
+                {
+                    std::cout << "rdkshell command was not applied in time\n";
+                }
+                else
+                {
+                    // the render thread is applying it right now
+                    applied = result.get();
+                }
+            }
+            // queued callers wait for the render thread instead of the mutex
+            addHistogramSample(gLockWaitStats, RdkShell::microseconds() - startTime);
+            releaseRdkShellCommand(command);
+            return applied;
         }
 
         std::string toLower(const std::string& clientName)
@@ -447,11 +1574,26 @@ namespace WPEFramework {
             return displayName;
         }
 
+        static void setLastForegroundTime(const std::string& client)
+        {
+            std::lock_guard<std::mutex> lock(gLastForegroundTimeMutex);
+            gLastForegroundTime[toLower(client)] = RdkShell::seconds();
+        }
+
         void RDKShell::MonitorClients::StateChange(PluginHost::IShell* service)
         {
             if (service)
             {
                 PluginHost::IShell::state currentState(service->State());
+                updatePluginStatus(service);
+                if (currentState == PluginHost::IShell::DEACTIVATION || currentState == PluginHost::IShell::DEACTIVATED)
+                {
+                    completeWillDestroy(service->Callsign());
+                }
+                if (currentState == PluginHost::IShell::DEACTIVATED || currentState == PluginHost::IShell::DESTROYED)
+                {
+                    releaseThunderClients(service->Callsign());
+                }
                 if (currentState == PluginHost::IShell::ACTIVATION)
                 {
                    std::string configLine = service->ConfigLine();
@@ -463,10 +1605,10 @@ namespace WPEFramework {
                    if (serviceConfig.HasLabel("clientidentifier"))
                    {
                        std::string clientidentifier = serviceConfig["clientidentifier"].String();
-                       gRdkShellMutex.lock();
+                       lockRdkShellMutex();
                        RdkShell::CompositorController::createDisplay(service->Callsign(), clientidentifier);
                        RdkShell::CompositorController::addListener(clientidentifier, mShell.mEventListener);
-                       gRdkShellMutex.unlock();
+                       unlockRdkShellMutex();
                        gPluginDataMutex.lock();
                        std::string className = service->ClassName();
                        PluginData pluginData;
@@ -567,10 +1709,10 @@ namespace WPEFramework {
                     if (serviceConfig.HasLabel("clientidentifier"))
                     {
                         std::string clientidentifier = serviceConfig["clientidentifier"].String();
-                        gRdkShellMutex.lock();
+                        lockRdkShellMutex();
                         RdkShell::CompositorController::kill(service->Callsign());
                         RdkShell::CompositorController::removeListener(clientidentifier, mShell.mEventListener);
-                        gRdkShellMutex.unlock();
+                        unlockRdkShellMutex();
                     }
                     
                     gPluginDataMutex.lock();
@@ -671,6 +1813,15 @@ namespace WPEFramework {
             registerMethod(RDKSHELL_METHOD_GET_LAST_WAKEUP_KEY, &RDKShell::getLastWakeupKeyWrapper, this);
             registerMethod(RDKSHELL_METHOD_GET_SCREENSHOT, &RDKShell::getScreenshotWrapper, this);
             registerMethod(RDKSHELL_METHOD_ENABLE_EASTER_EGGS, &RDKShell::enableEasterEggsWrapper, this);
+            registerMethod(RDKSHELL_METHOD_APPLY_LAYOUT, &RDKShell::applyLayoutWrapper, this);
+            registerMethod(RDKSHELL_METHOD_ACKNOWLEDGE_WILL_DESTROY, &RDKShell::acknowledgeWillDestroyWrapper, this);
+            registerMethod(RDKSHELL_METHOD_GET_FRAME_STATS, &RDKShell::getFrameStatsWrapper, this);
+            registerMethod(RDKSHELL_METHOD_SET_FRAME_STATS_INTERVAL, &RDKShell::setFrameStatsIntervalWrapper, this);
+            registerMethod(RDKSHELL_METHOD_GET_LAUNCH_HISTORY, &RDKShell::getLaunchHistoryWrapper, this);
+            registerMethod(RDKSHELL_METHOD_SET_PREWARM_APPS, &RDKShell::setPrewarmAppsWrapper, this);
+            registerMethod(RDKSHELL_METHOD_GET_PREWARM_APPS, &RDKShell::getPrewarmAppsWrapper, this);
+            registerMethod(RDKSHELL_METHOD_CANCEL_GENERATE_KEY, &RDKShell::cancelGenerateKeyWrapper, this);
+            registerMethod(RDKSHELL_METHOD_SET_EVICTION_POLICY, &RDKShell::setEvictionPolicyWrapper, this);
 
             m_timer.connect(std::bind(&RDKShell::onTimer, this));
         }
@@ -793,6 +1944,75 @@ namespace WPEFramework {
                 sFactoryModeBlockResidentApp = true;
             }
 
+            gScreenshotThreadRunning = true;
+            gScreenshotThread = std::thread([=]() {
+                std::unique_lock<std::mutex> lock(gScreenshotMutex);
+                while (gScreenshotThreadRunning || !gScreenshotJobs.empty())
+                {
+                    if (gScreenshotJobs.empty())
+                    {
+                        gScreenshotCondition.wait(lock);
+                        continue;
+                    }
+                    ScreenshotJob job = gScreenshotJobs.front();
+                    gScreenshotJobs.pop_front();
+                    lock.unlock();
+                    JsonObject params;
+                    if (processScreenshotJob(job, params))
+                    {
+                        notify(RDKSHELL_EVENT_ON_SCREENSHOT_COMPLETE, params);
+                    }
+                    job.data.reset();
+                    lock.lock();
+                }
+            });
+
+            char* prewarmIdleTimeValue = getenv("RDKSHELL_PREWARM_IDLE_TIME");
+            if (NULL != prewarmIdleTimeValue)
+            {
+                gPrewarmIdleTime = atoi(prewarmIdleTimeValue);
+            }
+            char* evictionProtectedAppsValue = getenv("RDKSHELL_EVICTION_PROTECTED_APPS");
+            gEvictionConfiguredProtectedApps.clear();
+            if (NULL != evictionProtectedAppsValue)
+            {
+                std::stringstream protectedAppsStream(evictionProtectedAppsValue);
+                std::string protectedApp;
+                while (std::getline(protectedAppsStream, protectedApp, ','))
+                {
+                    if (!protectedApp.empty())
+                    {
+                        gEvictionConfiguredProtectedApps.insert(protectedApp);
+                    }
+                }
+            }
+            else
+            {
+                gEvictionConfiguredProtectedApps.insert("factoryapp");
+            }
+            gKeySequenceThreadRunning = true;
+            gKeySequenceThread = std::thread([=]() {
+                runKeySequences();
+            });
+
+            gPrewarmThreadRunning = true;
+            gLastLaunchTime = RdkShell::seconds();
+            gPrewarmThread = std::thread([=]() {
+                std::unique_lock<std::mutex> lock(gPrewarmMutex);
+                while (gPrewarmThreadRunning)
+                {
+                    gPrewarmCondition.wait_for(lock, std::chrono::seconds(RDKSHELL_PREWARM_CHECK_INTERVAL_IN_SECONDS));
+                    if (!gPrewarmThreadRunning)
+                    {
+                        break;
+                    }
+                    lock.unlock();
+                    prewarmApps();
+                    evictApps();
+                    lock.lock();
+                }
+            });
+
             shellThread = std::thread([=]() {
                 bool isRunning = true;
                 gRdkShellMutex.lock();
@@ -833,12 +2053,18 @@ namespace WPEFramework {
                     }
                 }
                 isRunning = sRunning;
+                gRenderThreadId = std::this_thread::get_id();
+                gCommandQueueActive = true;
                 gRdkShellMutex.unlock();
                 gRdkShellSurfaceModeEnabled = CompositorController::isSurfaceModeEnabled();
+                double nextFrameStatsTime = 0;
                 while(isRunning) {
                   const double maxSleepTime = (1000 / gCurrentFramerate) * 1000;
                   double startFrameTime = RdkShell::microseconds();
                   gRdkShellMutex.lock();
+                  double lockedFrameTime = RdkShell::microseconds();
+                  addHistogramSample(gLockWaitStats, lockedFrameTime - startFrameTime);
+                  applyRdkShellCommands();
                   if (receivedResolutionRequest)
                   {
                     CompositorController::setScreenResolution(resolutionWidth, resolutionHeight);
@@ -865,23 +2091,10 @@ namespace WPEFramework {
                   {
                       if (!sPersistentStoreFirstActivated)
                       {
-                          Core::JSON::ArrayType<PluginHost::MetaData::Service> joResult;
-                          auto thunderController = getThunderControllerClient();
-                          int32_t status = thunderController->Get<Core::JSON::ArrayType<PluginHost::MetaData::Service>>(RDKSHELL_THUNDER_TIMEOUT, "status", joResult);
-                          JsonArray stateArray;
-                          for (uint16_t i = 0; i < joResult.Length(); i++)
+                          PluginStatusData statusData;
+                          if (findPluginStatus(pluginService, PERSISTENT_STORE_CALLSIGN, statusData) && statusData.mState == PluginHost::IShell::ACTIVATED)
                           {
-                              PluginHost::MetaData::Service service = joResult[i];
-                              std::string callsign;
-                              service.Callsign.ToString(callsign);
-                              if (callsign.find(PERSISTENT_STORE_CALLSIGN) != std::string::npos)
-                              {
-                                if (service.JSONState == PluginHost::MetaData::Service::state::ACTIVATED)
-                                {
-                                  sPersistentStoreFirstActivated = true;
-                                }
-                                break;
-                              } 
+                              sPersistentStoreFirstActivated = true;
                           }
                       }
                       sPersistentStorePreLaunchChecked = true;
@@ -907,6 +2120,7 @@ namespace WPEFramework {
                     {
                         JsonObject request, response;
                         std::cout << "about to launch factory app after persistent store wait\n";
+                        suspendRdkShellCommands();
                         gRdkShellMutex.unlock();
                         if (sFactoryModeBlockResidentApp)
                         {
@@ -915,6 +2129,7 @@ namespace WPEFramework {
                         request["resetagingtime"] = "true";
                         uint32_t status = rdkshellPlugin->launchFactoryAppWrapper(request, response);
                         gRdkShellMutex.lock();
+                        resumeRdkShellCommands();
                         std::cout << "launch factory app status:" << status << std::endl;
                     }
                     else
@@ -922,32 +2137,77 @@ namespace WPEFramework {
                         std::cout << "not launching factory app as conditions not matched\n";
                     }
                   }
+                  double drawStartTime = RdkShell::microseconds();
                   RdkShell::draw();
-                  if (needsScreenshot)
+                  double drawTime = RdkShell::microseconds() - drawStartTime;
+                  if (!gScreenshotRequests.empty())
                   {
                       uint8_t* data = nullptr;
-                      size_t size;
-                      string screenshotBase64;
+                      size_t size = 0;
+                      unsigned int width = 0, height = 0;
                       CompositorController::screenShot(data, size);
-                      size_t encodedImageSize = b64_get_encoded_buffer_size(size);
-                      uint8_t *encodedImage = (uint8_t*)malloc(encodedImageSize);
-                      b64_encode(&data[0], size, encodedImage);
-                      std::stringstream list1;
-                      for (unsigned int i=0; i<encodedImageSize; ++i){
-                         list1 << encodedImage[i];
+                      CompositorController::getScreenResolution(width, height);
+                      if (nullptr != data)
+                      {
+                          std::shared_ptr<uint8_t> pixels(data, free);
+                          std::lock_guard<std::mutex> lock(gScreenshotMutex);
+                          for (size_t i = 0; i < gScreenshotRequests.size(); i++)
+                          {
+                              ScreenshotJob job;
+                              job.request = gScreenshotRequests[i];
+                              job.data = pixels;
+                              job.size = size;
+                              job.width = width;
+                              job.height = height;
+                              gScreenshotJobs.push_back(job);
+                          }
+                          gScreenshotCondition.notify_one();
                       }
-                      screenshotBase64 = list1.str();
-                      std::cout << "Screenshot success size:" << size << std::endl;
-                      JsonObject params;
-                      params["imageData"] = screenshotBase64;
-                      notify(RDKSHELL_EVENT_ON_SCREENSHOT_COMPLETE, params);
-                      free(encodedImage);
-                      free(data);
-                      needsScreenshot = false;
+                      else
+                      {
+                          std::cout << "unable to capture screenshot\n";
+                      }
+                      gScreenshotRequests.clear();
                   }
+                  double updateStartTime = RdkShell::microseconds();
                   RdkShell::update();
+                  double updateTime = RdkShell::microseconds() - updateStartTime;
+                  std::vector<BoundsFence> appliedBounds;
+                  signalRdkShellFrameFence(appliedBounds);
                   isRunning = sRunning;
+                  double renderedFrameTime = RdkShell::microseconds();
                   gRdkShellMutex.unlock();
+                  addHistogramSample(gFrameTimeStats, drawTime + updateTime);
+                  addHistogramSample(gLockHoldStats, renderedFrameTime - lockedFrameTime);
+                  if (renderedFrameTime - startFrameTime > maxSleepTime)
+                  {
+                      gMissedFrames++;
+                  }
+                  const uint32_t frameStatsInterval = gFrameStatsInterval;
+                  if (frameStatsInterval > 0 && renderedFrameTime >= nextFrameStatsTime)
+                  {
+                      if (nextFrameStatsTime > 0)
+                      {
+                          JsonObject params;
+                          getFrameStats(params);
+                          notify(RDKSHELL_EVENT_ON_FRAME_STATS, params);
+                      }
+                      nextFrameStatsTime = renderedFrameTime + (frameStatsInterval * 1000000.0);
+                  }
+                  else if (frameStatsInterval == 0)
+                  {
+                      nextFrameStatsTime = 0;
+                  }
+                  for (size_t i = 0; i < appliedBounds.size(); i++)
+                  {
+                      JsonObject params;
+                      params["client"] = appliedBounds[i].client;
+                      params["x"] = appliedBounds[i].x;
+                      params["y"] = appliedBounds[i].y;
+                      params["w"] = appliedBounds[i].width;
+                      params["h"] = appliedBounds[i].height;
+                      notify(RDKSHELL_EVENT_ON_BOUNDS_APPLIED, params);
+                  }
                   double frameTime = (int)RdkShell::microseconds() - (int)startFrameTime;
                   if (frameTime < maxSleepTime)
                   {
@@ -955,6 +2215,10 @@ namespace WPEFramework {
                       usleep(sleepTime);
                   }
                 }
+                gRdkShellMutex.lock();
+                suspendRdkShellCommands();
+                std::atomic_store(&gRdkShellSnapshot, std::shared_ptr<const RdkShellSnapshot>());
+                gRdkShellMutex.unlock();
             });
 
             service->Register(mClientsMonitor);
@@ -1120,10 +2384,39 @@ namespace WPEFramework {
         void RDKShell::Deinitialize(PluginHost::IShell* service)
         {
             LOGINFO("Deinitialize");
+            gPrewarmMutex.lock();
+            gPrewarmThreadRunning = false;
+            gPrewarmCondition.notify_one();
+            gPrewarmMutex.unlock();
+            gPrewarmThread.join();
+            gPrewarmMutex.lock();
+            gPrewarmApps.clear();
+            gPrewarmedApps.clear();
+            gPrewarmEvictRequested = false;
+            gEvictionRequested = false;
+            gPrewarmMutex.unlock();
+            gLastForegroundTimeMutex.lock();
+            gLastForegroundTime.clear();
+            gLastForegroundTimeMutex.unlock();
+            gKeySequenceMutex.lock();
+            gKeySequenceThreadRunning = false;
+            gKeySequences.clear();
+            gKeySequenceCondition.notify_one();
+            gKeySequenceMutex.unlock();
+            gKeySequenceThread.join();
             gRdkShellMutex.lock();
             sRunning = false;
             gRdkShellMutex.unlock();
             shellThread.join();
+            gScreenshotMutex.lock();
+            gScreenshotThreadRunning = false;
+            gScreenshotCondition.notify_one();
+            gScreenshotMutex.unlock();
+            gScreenshotThread.join();
+            gScreenshotRequests.clear();
+            gFrameFenceMutex.lock();
+            gBoundsFences.clear();
+            gFrameFenceMutex.unlock();
             mCurrentService = nullptr;
             service->Unregister(mClientsMonitor);
             mClientsMonitor->Release();
@@ -1133,6 +2426,13 @@ namespace WPEFramework {
             mEventListener = nullptr;
             mEnableUserInactivityNotification = false;
             gActivePluginsData.clear();
+            gPluginStatusMutex.lock();
+            gPluginStatus.clear();
+            gPluginStatusLoaded = false;
+            gPluginStatusMutex.unlock();
+            gThunderClientsMutex.lock();
+            gThunderClients.clear();
+            gThunderClientsMutex.unlock();
         }
 
         string RDKShell::Information() const
@@ -1140,7 +2440,7 @@ namespace WPEFramework {
             return(string("{\"service\": \"") + SERVICE_NAME + string("\"}"));
         }
 
-        std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> > RDKShell::getThunderControllerClient(std::string callsign, std::string localidentifier)
+        std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> > RDKShell::createThunderControllerClient(std::string callsign, std::string localidentifier)
         {
             string query = "token=" + sThunderSecurityToken;
             Core::SystemInfo::SetEnvironment(_T("THUNDER_ACCESS"), (_T(gThunderAccessValue)));
@@ -1148,18 +2448,30 @@ namespace WPEFramework {
             return thunderClient;
         }
 
+        // links are kept open per callsign so that repeated calls do not pay for a new websocket
+        // connection each time.  use createThunderControllerClient for links that subscribe to events
+        std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> > RDKShell::getThunderControllerClient(std::string callsign, std::string localidentifier)
+        {
+            std::string clientName = localidentifier.empty() ? callsign : callsign + "@" + localidentifier;
+            std::lock_guard<std::mutex> lock(gThunderClientsMutex);
+            auto clientEntry = gThunderClients.find(clientName);
+            if (clientEntry != gThunderClients.end())
+            {
+                return clientEntry->second;
+            }
+            std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> > thunderClient = createThunderControllerClient(callsign, localidentifier);
+            gThunderClients[clientName] = thunderClient;
+            return thunderClient;
+        }
+
         std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement>> RDKShell::getPackagerPlugin()
         {
-            string query = "token=" + sThunderSecurityToken;
-            Core::SystemInfo::SetEnvironment(_T("THUNDER_ACCESS"), (_T(gThunderAccessValue)));
-            return make_shared<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement>>("Packager.1", "", false, query);
+            return getThunderControllerClient("Packager.1");
         }
 
         std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement>> RDKShell::getOCIContainerPlugin()
         {
-            string query = "token=" + sThunderSecurityToken;
-            Core::SystemInfo::SetEnvironment(_T("THUNDER_ACCESS"), (_T(gThunderAccessValue)));
-            return make_shared<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement>>("org.rdk.OCIContainer.1", "", false, query);
+            return getThunderControllerClient("org.rdk.OCIContainer.1");
         }
 
         void RDKShell::pluginEventHandler(const JsonObject& parameters)
@@ -1180,9 +2492,9 @@ namespace WPEFramework {
                 if ((prevState == "STANDBY" || prevState == "LIGHT_SLEEP" || prevState == "DEEP_SLEEP" || prevState == "OFF")
                     && powerState == "ON")
                 {
-                    gRdkShellMutex.lock();
+                    lockRdkShellMutexForRead();
                     CompositorController::getLastKeyPress(mLastWakeupKeyCode, mLastWakeupKeyModifiers, mLastWakeupKeyTimestamp);
-                    gRdkShellMutex.unlock();
+                    unlockRdkShellMutex();
                 }
             }
         }
@@ -1262,6 +2574,7 @@ namespace WPEFramework {
         void RDKShell::RdkShellListener::onDeviceLowRamWarning(const int32_t freeKb)
         {
           std::cout << "RDKShell onDeviceLowRamWarning event received ..." << freeKb << std::endl;
+          setLowRamWarningActive(true);
           JsonObject params;
           params["ram"] = freeKb;
           mShell.notify(RDKSHELL_EVENT_DEVICE_LOW_RAM_WARNING, params);
@@ -1270,6 +2583,7 @@ namespace WPEFramework {
         void RDKShell::RdkShellListener::onDeviceCriticallyLowRamWarning(const int32_t freeKb)
         {
           std::cout << "RDKShell onDeviceCriticallyLowRamWarning event received ..." << freeKb << std::endl;
+          setLowRamWarningActive(true);
           JsonObject params;
           params["ram"] = freeKb;
           mShell.notify(RDKSHELL_EVENT_DEVICE_CRITICALLY_LOW_RAM_WARNING, params);
@@ -1278,6 +2592,7 @@ namespace WPEFramework {
         void RDKShell::RdkShellListener::onDeviceLowRamWarningCleared(const int32_t freeKb)
         {
           std::cout << "RDKShell onDeviceLowRamWarningCleared event received ..." << freeKb << std::endl;
+          setLowRamWarningActive(false);
           JsonObject params;
           params["ram"] = freeKb;
           mShell.notify(RDKSHELL_EVENT_DEVICE_LOW_RAM_WARNING_CLEARED, params);
@@ -1350,18 +2665,22 @@ namespace WPEFramework {
                     if (actionObject.HasLabel("params"))
                     {
                         // setting wait Time to 2 seconds
+                        suspendRdkShellCommands();
                         gRdkShellMutex.unlock();
                         status = thunderController->Invoke(RDKSHELL_THUNDER_TIMEOUT, invoke.c_str(), actionObject["params"], joResult);
                         gRdkShellMutex.lock();
+                        resumeRdkShellCommands();
                     }
                     else
                     {
                       JsonObject joParams;
                       joParams["params"] = JsonObject();
                       // setting wait Time to 2 seconds
+                      suspendRdkShellCommands();
                       gRdkShellMutex.unlock();
                       status = thunderController->Invoke(RDKSHELL_THUNDER_TIMEOUT, invoke.c_str(), joParams, joResult);
                       gRdkShellMutex.lock();
+                      resumeRdkShellCommands();
                     }
                     if (status > 0)
                     {
@@ -1825,9 +3144,9 @@ namespace WPEFramework {
                 {
                     client = parameters["callsign"].String();
                 }
-                gRdkShellMutex.lock();
+                lockRdkShellMutex();
                 result = CompositorController::addKeyMetadataListener(client);
-                gRdkShellMutex.unlock();
+                unlockRdkShellMutex();
                 if (false == result) {
                   response["message"] = "failed to add key metadata listeners";
                 }
@@ -1859,7 +3178,7 @@ namespace WPEFramework {
                 }
                 lockRdkShellMutex();
                 result = CompositorController::removeKeyMetadataListener(client);
-                gRdkShellMutex.unlock();
+                unlockRdkShellMutex();
                 if (false == result) {
                   response["message"] = "failed to remove key metadata listeners";
                 }
@@ -1912,10 +3231,46 @@ namespace WPEFramework {
                 {
                   client = parameters.HasLabel("callsign") ? parameters["callsign"].String() : "";
                 }
-                result = generateKey(client, keyInputs);
+                const bool async = parameters.HasLabel("async") && parameters["async"].Boolean();
+                if (async)
+                {
+                    uint32_t sequenceId = 0;
+                    result = scheduleKeySequence(client, keyInputs, sequenceId);
+                    if (result)
+                    {
+                        response["sequenceId"] = sequenceId;
+                    }
+                    else
+                    {
+                        response["message"] = "no keys to generate";
+                    }
+                }
+                else
+                {
+                    result = generateKey(client, keyInputs);
+                    if (false == result) {
+                      response["message"] = "failed to generate keys";
+                    }
+                }
+            }
+            returnResponse(result);
+        }
 
-                if (false == result) {
-                  response["message"] = "failed to generate keys";
+        uint32_t RDKShell::cancelGenerateKeyWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+            bool result = true;
+            if (!parameters.HasLabel("sequenceId"))
+            {
+                result = false;
+                response["message"] = "please specify sequenceId";
+            }
+            if (result)
+            {
+                result = cancelKeySequence(parameters["sequenceId"].Number());
+                if (!result)
+                {
+                    response["message"] = "no pending key sequence with this id";
                 }
             }
             returnResponse(result);
@@ -2115,9 +3470,9 @@ namespace WPEFramework {
                 }
 
                 unsigned int x=0,y=0,w=0,h=0;
-                lockRdkShellMutex();
+                lockRdkShellMutexForRead();
                 CompositorController::getBounds(client, x, y, w, h);
-                gRdkShellMutex.unlock();
+                unlockRdkShellMutex();
                 if (parameters.HasLabel("x"))
                 {
                     x  = parameters["x"].Number();
@@ -2135,7 +3490,13 @@ namespace WPEFramework {
                     h  = parameters["h"].Number();
                 }
 
-                result = setBounds(client, x, y, w, h);
+                bool waitForFrame = false;
+                if (parameters.HasLabel("waitForFrame"))
+                {
+                    waitForFrame = parameters["waitForFrame"].Boolean();
+                }
+
+                result = setBounds(client, x, y, w, h, waitForFrame);
                 if (false == result) {
                   response["message"] = "failed to set bounds";
                 }
@@ -2456,9 +3817,9 @@ namespace WPEFramework {
             LOGINFOMETHOD();
             bool result = true;
             std::string logLevel = "INFO";
-            lockRdkShellMutex();
+            lockRdkShellMutexForRead();
             result = CompositorController::getLogLevel(logLevel);
-            gRdkShellMutex.unlock();
+            unlockRdkShellMutex();
             if (false == result) {
                 response["message"] = "failed to get log level";
             }
@@ -2484,7 +3845,7 @@ namespace WPEFramework {
                 lockRdkShellMutex();
                 result = CompositorController::setLogLevel(logLevel);
                 CompositorController::getLogLevel(currentLogLevel);
-                gRdkShellMutex.unlock();
+                unlockRdkShellMutex();
                 if (false == result) {
                     response["message"] = "failed to set log level";
                 }
@@ -2511,7 +3872,7 @@ namespace WPEFramework {
                 lockRdkShellMutex();
                 gSplashScreenDisplayTime = displayTime;
                 receivedShowSplashScreenRequest = true;
-                gRdkShellMutex.unlock();
+                unlockRdkShellMutex();
                 if (false == result) {
                     response["message"] = "failed to show splash screen";
                 }
@@ -2526,7 +3887,7 @@ namespace WPEFramework {
 
             lockRdkShellMutex();
             result = CompositorController::hideSplashScreen();
-            gRdkShellMutex.unlock();
+            unlockRdkShellMutex();
 
             returnResponse(result);
         }
@@ -2676,28 +4037,28 @@ namespace WPEFramework {
                     client = parameters["callsign"].String();
                 }
 
-                unsigned int x = 0, y = 0;
-                unsigned int clientWidth = 0, clientHeight = 0;
-                lockRdkShellMutex();
-                CompositorController::getBounds(client, x, y, clientWidth, clientHeight);
-                if (parameters.HasLabel("x"))
-                {
-                    x = parameters["x"].Number();
-                }
-                if (parameters.HasLabel("y"))
-                {
-                    y = parameters["y"].Number();
-                }
-                if (parameters.HasLabel("w"))
-                {
-                    clientWidth = parameters["w"].Number();
-                }
-                if (parameters.HasLabel("h"))
-                {
-                    clientHeight = parameters["h"].Number();
-                }
-                result = CompositorController::scaleToFit(client, x, y, clientWidth, clientHeight);
-                gRdkShellMutex.unlock();
+                result = runRdkShellCommand([&]() {
+                    unsigned int x = 0, y = 0;
+                    unsigned int clientWidth = 0, clientHeight = 0;
+                    CompositorController::getBounds(client, x, y, clientWidth, clientHeight);
+                    if (parameters.HasLabel("x"))
+                    {
+                        x = parameters["x"].Number();
+                    }
+                    if (parameters.HasLabel("y"))
+                    {
+                        y = parameters["y"].Number();
+                    }
+                    if (parameters.HasLabel("w"))
+                    {
+                        clientWidth = parameters["w"].Number();
+                    }
+                    if (parameters.HasLabel("h"))
+                    {
+                        clientHeight = parameters["h"].Number();
+                    }
+                    return CompositorController::scaleToFit(client, x, y, clientWidth, clientHeight);
+                });
 
                 if (!result) {
                   response["message"] = "failed to scale to fit";
@@ -2709,8 +4070,14 @@ namespace WPEFramework {
         uint32_t RDKShell::launchWrapper(const JsonObject& parameters, JsonObject& response)
         {
             LOGINFOMETHOD();
+            return launchApp(parameters, response, false);
+        }
 
+        // prewarm launches come from the prewarm thread only, they do not adopt an existing warm instance
+        uint32_t RDKShell::launchApp(const JsonObject& parameters, JsonObject& response, const bool prewarm)
+        {
             double launchStartTime = RdkShell::seconds();
+            std::unique_ptr<LaunchTimeline> timeline;
             bool result = true;
             if (!parameters.HasLabel("callsign"))
             {
@@ -2746,6 +4113,7 @@ namespace WPEFramework {
             if (result)
             {
                 appCallsign = parameters["callsign"].String();
+                timeline.reset(new LaunchTimeline(appCallsign));
                 bool isApplicationBeingDestroyed = false;
                 gLaunchDestroyMutex.lock();
                 if (gDestroyApplications.find(appCallsign) != gDestroyApplications.end())
@@ -2768,6 +4136,15 @@ namespace WPEFramework {
                 RDKShellLaunchType launchType = RDKShellLaunchType::UNKNOWN;
                 const string callsign = parameters["callsign"].String();
                 const string callsignWithVersion = callsign + ".1";
+                if (!prewarm)
+                {
+                    gPrewarmMutex.lock();
+                    if (gPrewarmedApps.erase(callsign) > 0)
+                    {
+                        std::cout << "adopting prewarmed instance of " << callsign << std::endl;
+                    }
+                    gPrewarmMutex.unlock();
+                }
                 string type;
                 if (parameters.HasLabel("type"))
                 {
@@ -2870,25 +4247,9 @@ namespace WPEFramework {
                     if (topmost)
                     {
                         std::string topmostClient;
-                        {
-                            bool lockAcquired = false;
-                            double startTime = RdkShell::milliseconds();
-                            while (!lockAcquired && (RdkShell::milliseconds() - startTime) < RDKSHELL_TRY_LOCK_WAIT_TIME_IN_MS)
-                            {
-                                lockAcquired = gRdkShellMutex.try_lock();
-                            }
-                            if (!lockAcquired)
-                            {
-                                std::cout << "unable to get lock for topmost, defaulting to normal lock\n";
-                                gRdkShellMutex.lock();
-                            }
-                            else
-                            {
-                                std::cout << "lock was acquired via try for topmost\n";
-                            }
-                        }
+                        lockRdkShellMutexForRead();
                         bool topmostResult =  CompositorController::getTopmost(topmostClient);
-                        gRdkShellMutex.unlock();
+                        unlockRdkShellMutex();
                         if (!topmostClient.empty())
                         {
                             response["message"] = "failed to launch application.  topmost application already present";
@@ -2924,34 +4285,20 @@ namespace WPEFramework {
                 //auto thunderController = getThunderControllerClient();
                 if ((false == newPluginFound) && (false == originalPluginFound))
                 {
-                    Core::JSON::ArrayType<PluginHost::MetaData::Service> availablePluginResult;
-                    uint32_t status = thunderController->Get<Core::JSON::ArrayType<PluginHost::MetaData::Service>>(RDKSHELL_THUNDER_TIMEOUT, "status", availablePluginResult);
-
-                    std::cout << "status status: " << status << std::endl;
-                    if (status > 0)
+                    PluginStatusData statusData;
+                    newPluginFound = findPluginStatus(mCurrentService, callsign, statusData);
+                    originalPluginFound = !newPluginFound && findPluginStatus(mCurrentService, type, statusData);
+                    if (!newPluginFound && !originalPluginFound)
                     {
-                        std::cout << "trying status one more time...\n";
-                        status = thunderController->Get<Core::JSON::ArrayType<PluginHost::MetaData::Service>>(RDKSHELL_THUNDER_TIMEOUT, "status", availablePluginResult);
-                        std::cout << "status status: " << status << std::endl;
-                    }
-
-                    for (uint16_t i = 0; i < availablePluginResult.Length(); i++)
-                    {
-                        PluginHost::MetaData::Service service = availablePluginResult[i];
-                        std::string pluginName = service.Callsign.Value();
-                        pluginName.erase(std::remove(pluginName.begin(),pluginName.end(),'\"'),pluginName.end());
-                        if (!pluginName.empty() && pluginName == callsign)
-                        {
-                            newPluginFound = true;
-                            break;
-                        }
-                        else if (!pluginName.empty() && pluginName == type)
-                        {
-                            originalPluginFound = true;
-                        }
+                        // clones that have never been activated are not in the cache, reload it from the controller
+                        loadPluginStatus(mCurrentService);
+                        newPluginFound = findPluginStatus(mCurrentService, callsign, statusData);
+                        originalPluginFound = !newPluginFound && findPluginStatus(mCurrentService, type, statusData);
                     }
-                    pluginsFound = availablePluginResult.Length();
+                    std::lock_guard<std::mutex> lock(gPluginStatusMutex);
+                    pluginsFound = gPluginStatus.size();
                 }
+                timeline->mark("lookup");
 
                 if (!newPluginFound && !originalPluginFound)
                 {
@@ -2992,25 +4339,11 @@ namespace WPEFramework {
                     joParams.ToString(strParams);
                     joResult.ToString(strResult);
                     launchType = RDKShellLaunchType::CREATE;
-                    {
-                        bool lockAcquired = false;
-                        double startTime = RdkShell::milliseconds();
-                        while (!lockAcquired && (RdkShell::milliseconds() - startTime) < RDKSHELL_TRY_LOCK_WAIT_TIME_IN_MS)
-                        {
-                            lockAcquired = gRdkShellMutex.try_lock();
-                        }
-                        if (!lockAcquired)
-                        {
-                            std::cout << "unable to get lock for create display, defaulting to normal lock\n";
-                            gRdkShellMutex.lock();
-                        }
-                        else
-                        {
-                            std::cout << "lock was acquired via try for create display\n";
-                        }
-                    }
-                    RdkShell::CompositorController::createDisplay(callsign, displayName, width, height);
-                    gRdkShellMutex.unlock();
+                    timeline->mark("clone");
+                    runRdkShellCommand([&]() {
+                        return RdkShell::CompositorController::createDisplay(callsign, displayName, width, height);
+                    });
+                    timeline->mark("createDisplay");
                 }
 
                 WPEFramework::Core::JSON::String configString;
@@ -3018,6 +4351,7 @@ namespace WPEFramework {
                 uint32_t status = 0;
                 string method = "configuration@" + callsign;
                 Core::JSON::ArrayType<PluginHost::MetaData::Service> joResult;
+                // always read the configuration from the controller, it may have been changed since the plugin was activated
                 status = thunderController->Get<WPEFramework::Core::JSON::String>(RDKSHELL_THUNDER_TIMEOUT, method.c_str(), configString);
 
                 std::cout << "config status: " << status << std::endl;
@@ -3130,28 +4464,52 @@ namespace WPEFramework {
                     status = thunderController->Set<JsonObject>(RDKSHELL_THUNDER_TIMEOUT, method.c_str(), configSet);
                     std::cout << "set status: " << status << std::endl;
                 }
+                if (status == 0)
+                {
+                    string configLine;
+                    configSet.ToString(configLine);
+                    updatePluginConfigLine(callsign, configLine);
+                }
+                timeline->mark("configuration");
 
                 if (launchType == RDKShellLaunchType::UNKNOWN)
                 {
                     status = 0;
-                    string statusMethod = "status@"+callsign;
-                    Core::JSON::ArrayType<PluginHost::MetaData::Service> serviceResults;
-                    status = thunderController->Get<Core::JSON::ArrayType<PluginHost::MetaData::Service> >(RDKSHELL_THUNDER_TIMEOUT, statusMethod.c_str(),serviceResults);
-
-                    std::cout << "get status: " << status << std::endl;
-                    if (status > 0)
+                    bool pluginActive = false;
+                    PluginStatusData cachedStatus;
+                    if (findPluginStatus(mCurrentService, callsign, cachedStatus))
                     {
-                        std::cout << "trying status one more time...\n";
+                        pluginActive = isPluginStatusActive(cachedStatus);
+                    }
+                    else
+                    {
+                        string statusMethod = "status@"+callsign;
+                        Core::JSON::ArrayType<PluginHost::MetaData::Service> serviceResults;
                         status = thunderController->Get<Core::JSON::ArrayType<PluginHost::MetaData::Service> >(RDKSHELL_THUNDER_TIMEOUT, statusMethod.c_str(),serviceResults);
+
                         std::cout << "get status: " << status << std::endl;
+                        if (status > 0)
+                        {
+                            std::cout << "trying status one more time...\n";
+                            status = thunderController->Get<Core::JSON::ArrayType<PluginHost::MetaData::Service> >(RDKSHELL_THUNDER_TIMEOUT, statusMethod.c_str(),serviceResults);
+                            std::cout << "get status: " << status << std::endl;
+                        }
+                        if (status == 0 && serviceResults.Length() > 0)
+                        {
+                            PluginHost::MetaData::Service service = serviceResults[0];
+                            pluginActive = (service.JSONState != PluginHost::MetaData::Service::state::DEACTIVATED &&
+                                service.JSONState != PluginHost::MetaData::Service::state::DEACTIVATION &&
+                                service.JSONState != PluginHost::MetaData::Service::state::PRECONDITION);
+                        }
+                        else
+                        {
+                            status = Core::ERROR_GENERAL;
+                        }
                     }
 
-                    if (status == 0 && serviceResults.Length() > 0)
+                    if (status == 0)
                     {
-                        PluginHost::MetaData::Service service = serviceResults[0];
-                        if (service.JSONState == PluginHost::MetaData::Service::state::DEACTIVATED ||
-                            service.JSONState == PluginHost::MetaData::Service::state::DEACTIVATION ||
-                            service.JSONState == PluginHost::MetaData::Service::state::PRECONDITION)
+                        if (!pluginActive)
                         {
                             launchType = RDKShellLaunchType::ACTIVATE;
                             JsonObject activateParams;
@@ -3203,6 +4561,7 @@ namespace WPEFramework {
                     }
                 }
 
+                timeline->mark("activate");
                 bool deferLaunch = false;
                 if (status > 0)
                 {
@@ -3215,25 +4574,9 @@ namespace WPEFramework {
                     uint32_t tempY = 0;
                     uint32_t screenWidth = 0;
                     uint32_t screenHeight = 0;
-                    {
-                        bool lockAcquired = false;
-                        double startTime = RdkShell::milliseconds();
-                        while (!lockAcquired && (RdkShell::milliseconds() - startTime) < RDKSHELL_TRY_LOCK_WAIT_TIME_IN_MS)
-                        {
-                            lockAcquired = gRdkShellMutex.try_lock();
-                        }
-                        if (!lockAcquired)
-                        {
-                            std::cout << "unable to get lock for get bounds, defaulting to normal lock\n";
-                            gRdkShellMutex.lock();
-                        }
-                        else
-                        {
-                            std::cout << "lock was acquired via try for get bounds\n";
-                        }
-                    }
+                    lockRdkShellMutexForRead();
                     CompositorController::getBounds(callsign, tempX, tempY, screenWidth, screenHeight);
-                    gRdkShellMutex.unlock();
+                    unlockRdkShellMutex();
                     width = screenWidth;
                     height = screenHeight;
                     if (parameters.HasLabel("x"))
@@ -3252,27 +4595,11 @@ namespace WPEFramework {
                     {
                         height = parameters["h"].Number();
                     }
-                    {
-                        bool lockAcquired = false;
-                        double startTime = RdkShell::milliseconds();
-                        while (!lockAcquired && (RdkShell::milliseconds() - startTime) < RDKSHELL_TRY_LOCK_WAIT_TIME_IN_MS)
-                        {
-                            lockAcquired = gRdkShellMutex.try_lock();
-                        }
-                        if (!lockAcquired)
-                        {
-                            std::cout << "unable to get lock for set bounds, defaulting to normal lock\n";
-                            gRdkShellMutex.lock();
-                        }
-                        else
-                        {
-                            std::cout << "lock was acquired via try for set bounds\n";
-                        }
-                    }
                     std::cout << "setting the desired bounds\n";
-                    CompositorController::setBounds(callsign, 0, 0, 1, 1); //forcing a compositor resize flush
-                    CompositorController::setBounds(callsign, x, y, width, height);
-                    gRdkShellMutex.unlock();
+                    runRdkShellCommand([&]() {
+                        CompositorController::setBounds(callsign, 0, 0, 1, 1); //forcing a compositor resize flush
+                        return CompositorController::setBounds(callsign, x, y, width, height);
+                    });
 
                     if (scaleToFit)
                     {
@@ -3300,6 +4627,7 @@ namespace WPEFramework {
                             std::cout << "unable to move behind " << behind << std::endl;
                         }
                     }
+                    timeline->mark("bounds");
 
                     gPluginDataMutex.lock();
                     {
@@ -3368,6 +4696,8 @@ namespace WPEFramework {
                         }
                     }
 
+                    timeline->mark("state");
+
                     setVisibility(callsign, visible);
                     setHolePunch(callsign, holePunch);
                     if (!visible)
@@ -3381,6 +4711,7 @@ namespace WPEFramework {
                     }
 
                     bool setTopmostResult = setTopmost(callsign, topmost);
+                    timeline->mark("focus");
                     JsonObject urlResult;
                     if (!uri.empty())
                     {
@@ -3391,6 +4722,7 @@ namespace WPEFramework {
                         {
                             std::cout << "failed to set url to " << uri << " with status code " << status << std::endl;
                         }
+                        timeline->mark("url");
                     }
                 }
 
@@ -3446,6 +4778,17 @@ namespace WPEFramework {
             gLaunchApplications.erase(appCallsign);
 	    gLaunchDestroyMutex.unlock();
             std::cout << "new launch count at loc2 is 0\n";
+            gPrewarmMutex.lock();
+            gLastLaunchTime = RdkShell::seconds();
+            gPrewarmMutex.unlock();
+
+            if (timeline)
+            {
+                JsonObject launchTimeline;
+                timeline->finish(response.HasLabel("launchType") ? response["launchType"].String() : "unknown", result, launchTimeline);
+                addLaunchHistory(launchTimeline);
+                notify(RDKSHELL_EVENT_ON_LAUNCH_TIMELINE, launchTimeline);
+            }
 
             returnResponse(result);
         }
@@ -3510,63 +4853,73 @@ namespace WPEFramework {
         {
             LOGINFOMETHOD();
             bool result = true;
+            string message = "failed to destroy application";
             if (!parameters.HasLabel("callsign"))
             {
                 result = false;
-                response["message"] = "please specify callsign";
             }
             if (result)
             {
-                const string callsign = parameters["callsign"].String();
-                bool isApplicationBeingLaunched = false;
-		gLaunchDestroyMutex.lock();
-                if (gLaunchApplications.find(callsign) != gLaunchApplications.end())
-                {
-                    isApplicationBeingLaunched = true;
-                }
-                else
-                {
-                    gDestroyApplications[callsign] = true;
-                }
-		gLaunchDestroyMutex.unlock();
-                if (isApplicationBeingLaunched)
-                {
-                    std::cout << "failed to destroy " << callsign << " as launch in progress" << std::endl;
-                    response["message"] = "failed to destroy application as same application being launched";
-                    returnResponse(false);
-                }
-                std::cout << "destroying " << callsign << std::endl;
-                JsonObject joParams;
-                joParams.Set("callsign",callsign.c_str());
-                JsonObject joResult;
-                auto thunderController = getThunderControllerClient();
-                uint32_t status = thunderController->Invoke(RDKSHELL_THUNDER_TIMEOUT, "deactivate", joParams, joResult);
-                if (status > 0)
-                {
-                    std::cout << "failed to destroy " << callsign << ".  status: " << status << std::endl;
-                    result = false;
-                }
-                else
-                {
-                    if (callsign == "factoryapp")
-                    {
-                        removeFactoryModeEasterEggs();
-                        sFactoryModeStart = false;
-                        sFactoryAppLaunchStatus = NOTLAUNCHED;
-                    }
-                    onDestroyed(callsign);
-                }
-		gLaunchDestroyMutex.lock();
-                gDestroyApplications.erase(callsign);
-		gLaunchDestroyMutex.unlock();
+                result = destroyApp(parameters["callsign"].String(), message);
             }
             if (!result)
             {
-                response["message"] = "failed to destroy application";
+                response["message"] = message;
             }
             returnResponse(result);
         }
 
+        // shared by the destroy api and the prewarm thread, message is only set when a launch of the app is in progress
+        bool RDKShell::destroyApp(const std::string& callsign, std::string& message)
+        {
+            bool result = true;
+            bool isApplicationBeingLaunched = false;
+            gLaunchDestroyMutex.lock();
+            if (gLaunchApplications.find(callsign) != gLaunchApplications.end())
+            {
+                isApplicationBeingLaunched = true;
+            }
+            else
+            {
+                gDestroyApplications[callsign] = true;
+            }
+            gLaunchDestroyMutex.unlock();
+            if (isApplicationBeingLaunched)
+            {
+                std::cout << "failed to destroy " << callsign << " as launch in progress" << std::endl;
+                message = "failed to destroy application as same application being launched";
+                return false;
+            }
+            std::cout << "destroying " << callsign << std::endl;
+            JsonObject joParams;
+            joParams.Set("callsign",callsign.c_str());
+            JsonObject joResult;
+            auto thunderController = getThunderControllerClient();
+            uint32_t status = thunderController->Invoke(RDKSHELL_THUNDER_TIMEOUT, "deactivate", joParams, joResult);
+            if (status > 0)
+            {
+                std::cout << "failed to destroy " << callsign << ".  status: " << status << std::endl;
+                result = false;
+            }
+            else
+            {
+                if (callsign == "factoryapp")
+                {
+                    removeFactoryModeEasterEggs();
+                    sFactoryModeStart = false;
+                    sFactoryAppLaunchStatus = NOTLAUNCHED;
+                }
+                gPrewarmMutex.lock();
+                gPrewarmedApps.erase(callsign);
+                gPrewarmMutex.unlock();
+                onDestroyed(callsign);
+            }
+            gLaunchDestroyMutex.lock();
+            gDestroyApplications.erase(callsign);
+            gLaunchDestroyMutex.unlock();
+            return result;
+        }
+
         uint32_t RDKShell::launchApplicationWrapper(const JsonObject& parameters, JsonObject& response)
         {
             LOGINFOMETHOD();
@@ -3672,9 +5025,9 @@ namespace WPEFramework {
                 }
                 else if (mimeType == RDKSHELL_APPLICATION_MIME_TYPE_NATIVE)
                 {
-                    gRdkShellMutex.lock();
+                    lockRdkShellMutex();
                     result = CompositorController::launchApplication(client, uri, mimeType);
-                    gRdkShellMutex.unlock();
+                    unlockRdkShellMutex();
 
                     if (!result)
                     {
@@ -3714,7 +5067,7 @@ namespace WPEFramework {
                 {
                     lockRdkShellMutex();
                     result = CompositorController::suspendApplication(client);
-                    gRdkShellMutex.unlock();
+                    unlockRdkShellMutex();
                 }
                 else if (mimeType == RDKSHELL_APPLICATION_MIME_TYPE_DAC_NATIVE)
                 {
@@ -3781,7 +5134,7 @@ namespace WPEFramework {
                 {
                     lockRdkShellMutex();
                     result = CompositorController::resumeApplication(client);
-                    gRdkShellMutex.unlock();
+                    unlockRdkShellMutex();
                 }
                 else if (mimeType == RDKSHELL_APPLICATION_MIME_TYPE_DAC_NATIVE)
                 {
@@ -3829,27 +5182,15 @@ namespace WPEFramework {
             LOGINFOMETHOD();
             bool result = true;
 
-            string method = "status";
-            Core::JSON::ArrayType<PluginHost::MetaData::Service> joResult;
-            auto thunderController = getThunderControllerClient();
-            uint32_t status = thunderController->Get<Core::JSON::ArrayType<PluginHost::MetaData::Service>>(RDKSHELL_THUNDER_TIMEOUT, method.c_str(), joResult);
+            std::map<std::string, PluginStatusData> pluginStatus;
+            getPluginStatus(mCurrentService, pluginStatus);
 
             JsonArray availableTypes;
-            for (uint16_t i = 0; i < joResult.Length(); i++)
+            for (auto statusEntry = pluginStatus.begin(); statusEntry != pluginStatus.end(); statusEntry++)
             {
-                PluginHost::MetaData::Service service = joResult[i];
-                std::string configLine;
-                service.Configuration.ToString(configLine);
-                if (!configLine.empty())
+                if (statusEntry->second.mHasClientIdentifier)
                 {
-                    JsonObject serviceConfig = JsonObject(configLine.c_str());
-                    if (serviceConfig.HasLabel("clientidentifier"))
-                    {
-                        std::string typeName;
-                        service.Callsign.ToString(typeName);
-                        typeName.erase(std::remove(typeName.begin(),typeName.end(),'\"'),typeName.end());
-                        availableTypes.Add(typeName);
-                    }
+                    availableTypes.Add(statusEntry->first);
                 }
             }
             response["types"] = availableTypes;
@@ -3924,6 +5265,191 @@ namespace WPEFramework {
             returnResponse(result);
         }
 
+        uint32_t RDKShell::acknowledgeWillDestroyWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+            bool result = true;
+            if (!parameters.HasLabel("callsign"))
+            {
+                result = false;
+                response["message"] = "please specify callsign";
+            }
+            if (result)
+            {
+                const string callsign = parameters["callsign"].String();
+                completeWillDestroy(callsign);
+            }
+            returnResponse(result);
+        }
+
+        uint32_t RDKShell::getFrameStatsWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+            bool result = true;
+            getFrameStats(response);
+            if (parameters.HasLabel("reset") && parameters["reset"].Boolean())
+            {
+                resetFrameStats();
+            }
+            returnResponse(result);
+        }
+
+        uint32_t RDKShell::setFrameStatsIntervalWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+            bool result = true;
+            if (!parameters.HasLabel("interval"))
+            {
+                result = false;
+                response["message"] = "please specify interval parameter";
+            }
+            if (result)
+            {
+                gFrameStatsInterval = parameters["interval"].Number();
+            }
+            returnResponse(result);
+        }
+
+        uint32_t RDKShell::getLaunchHistoryWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+            bool result = true;
+            string callsign;
+            if (parameters.HasLabel("callsign"))
+            {
+                callsign = parameters["callsign"].String();
+            }
+            JsonArray launches;
+            gLaunchHistoryMutex.lock();
+            for (auto launchEntry = gLaunchHistory.begin(); launchEntry != gLaunchHistory.end(); launchEntry++)
+            {
+                if (callsign.empty() || (*launchEntry)["callsign"].String() == callsign)
+                {
+                    launches.Add(*launchEntry);
+                }
+            }
+            gLaunchHistoryMutex.unlock();
+            response["launches"] = launches;
+            returnResponse(result);
+        }
+
+        uint32_t RDKShell::setPrewarmAppsWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+            bool result = true;
+            if (!parameters.HasLabel("apps"))
+            {
+                result = false;
+                response["message"] = "please specify apps";
+            }
+            if (result)
+            {
+                const JsonArray apps = parameters["apps"].Array();
+                std::vector<PrewarmApp> prewarmApps;
+                for (int i=0; i<apps.Length(); i++)
+                {
+                    const JsonObject& appInfo = apps[i].Object();
+                    if (!appInfo.HasLabel("type"))
+                    {
+                        result = false;
+                        response["message"] = "please specify type for every app";
+                        break;
+                    }
+                    PrewarmApp prewarmApp;
+                    prewarmApp.type = appInfo["type"].String();
+                    prewarmApp.callsign = appInfo.HasLabel("callsign") ? appInfo["callsign"].String() : prewarmApp.type;
+                    if (appInfo.HasLabel("uri"))
+                    {
+                        prewarmApp.uri = appInfo["uri"].String();
+                    }
+                    prewarmApps.push_back(prewarmApp);
+                }
+                if (result)
+                {
+                    std::lock_guard<std::mutex> lock(gPrewarmMutex);
+                    gPrewarmApps = prewarmApps;
+                    // warm instances that are no longer part of the pool are destroyed on the next check
+                    gPrewarmEvictRequested = !gPrewarmedApps.empty();
+                    gPrewarmCondition.notify_one();
+                }
+            }
+            returnResponse(result);
+        }
+
+        uint32_t RDKShell::setEvictionPolicyWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+            bool result = true;
+            if (!parameters.HasLabel("enable"))
+            {
+                result = false;
+                response["message"] = "please specify enable parameter";
+            }
+            if (result)
+            {
+                std::set<std::string> protectedApps;
+                const JsonArray protectedList = parameters.HasLabel("protected") ? parameters["protected"].Array() : JsonArray();
+                for (int i=0; i<protectedList.Length(); i++)
+                {
+                    protectedApps.insert(protectedList[i].String());
+                }
+                std::lock_guard<std::mutex> lock(gPrewarmMutex);
+                gEvictionEnabled = parameters["enable"].Boolean();
+                gEvictionProtectedApps = protectedApps;
+                gEvictionRequested = gEvictionEnabled && gLowRamWarningActive;
+                if (gEvictionRequested)
+                {
+                    gPrewarmCondition.notify_one();
+                }
+            }
+            returnResponse(result);
+        }
+
+        uint32_t RDKShell::getPrewarmAppsWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+            bool result = true;
+            JsonArray apps;
+            gPrewarmMutex.lock();
+            for (size_t i = 0; i < gPrewarmApps.size(); i++)
+            {
+                JsonObject appInfo;
+                appInfo["callsign"] = gPrewarmApps[i].callsign;
+                appInfo["type"] = gPrewarmApps[i].type;
+                appInfo["uri"] = gPrewarmApps[i].uri;
+                appInfo["warm"] = (gPrewarmedApps.find(gPrewarmApps[i].callsign) != gPrewarmedApps.end());
+                apps.Add(appInfo);
+            }
+            gPrewarmMutex.unlock();
+            response["apps"] = apps;
+            returnResponse(result);
+        }
+
+        uint32_t RDKShell::applyLayoutWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+            bool result = true;
+            if (!parameters.HasLabel("layout"))
+            {
+                result = false;
+                response["message"] = "please specify layout";
+            }
+            if (result)
+            {
+                const JsonArray layout = parameters["layout"].Array();
+                bool waitForFrame = false;
+                if (parameters.HasLabel("waitForFrame"))
+                {
+                    waitForFrame = parameters["waitForFrame"].Boolean();
+                }
+                result = applyLayout(layout, waitForFrame);
+                if (false == result) {
+                    response["message"] = "failed to apply layout";
+                }
+            }
+            returnResponse(result);
+        }
+
         uint32_t RDKShell::showFullScreenImageWrapper(const JsonObject& parameters, JsonObject& response)
         {
             LOGINFOMETHOD();
@@ -3952,7 +5478,7 @@ namespace WPEFramework {
 
             lockRdkShellMutex();
             result = CompositorController::hideFullScreenImage();
-            gRdkShellMutex.unlock();
+            unlockRdkShellMutex();
 
             returnResponse(result);
         }
@@ -3962,61 +5488,47 @@ namespace WPEFramework {
             LOGINFOMETHOD();
             bool result = true;
 
-            string method = "status";
-            Core::JSON::ArrayType<PluginHost::MetaData::Service> joResult;
-            auto thunderController = getThunderControllerClient();
-            uint32_t status = thunderController->Get<Core::JSON::ArrayType<PluginHost::MetaData::Service>>(RDKSHELL_THUNDER_TIMEOUT, method.c_str(), joResult);
+            JsonArray stateArray;
+            getAppStates(stateArray);
+            response["state"] = stateArray;
 
+            returnResponse(result);
+        }
 
-            JsonArray stateArray;
-            for (uint16_t i = 0; i < joResult.Length(); i++)
+        void RDKShell::getAppStates(JsonArray& stateArray)
+        {
+            std::map<std::string, PluginStatusData> pluginStatus;
+            getPluginStatus(mCurrentService, pluginStatus);
+
+            for (auto statusEntry = pluginStatus.begin(); statusEntry != pluginStatus.end(); statusEntry++)
             {
-                PluginHost::MetaData::Service service = joResult[i];
-                if (service.JSONState != PluginHost::MetaData::Service::state::DEACTIVATED &&
-                    service.JSONState != PluginHost::MetaData::Service::state::DEACTIVATION &&
-                    service.JSONState != PluginHost::MetaData::Service::state::PRECONDITION)
+                if (isPluginStatusActive(statusEntry->second) && statusEntry->second.mHasClientIdentifier)
                 {
-                    std::string configLine;
-                    service.Configuration.ToString(configLine);
-                    if (!configLine.empty())
-                    {
-                        JsonObject serviceConfig = JsonObject(configLine.c_str());
-                        if (serviceConfig.HasLabel("clientidentifier"))
-                        {
-                            std::string callsign;
-                            service.Callsign.ToString(callsign);
-                            callsign.erase(std::remove(callsign.begin(),callsign.end(),'\"'),callsign.end());
-
-                            WPEFramework::Core::JSON::String stateString;
-                            const string callsignWithVersion = callsign + ".1";
-                            auto thunderPlugin = getThunderControllerClient(callsignWithVersion);
-                            uint32_t stateStatus = thunderPlugin->Get<WPEFramework::Core::JSON::String>(RDKSHELL_THUNDER_TIMEOUT, "state", stateString);
+                    const std::string& callsign = statusEntry->first;
+                    WPEFramework::Core::JSON::String stateString;
+                    JSONRPCDirectLink thunderPlugin(mCurrentService, callsign);
+                    uint32_t stateStatus = thunderPlugin.Get<WPEFramework::Core::JSON::String>(RDKSHELL_THUNDER_TIMEOUT, "state", stateString);
 
-                            if (stateStatus == 0)
-                            {
-                                WPEFramework::Core::JSON::String urlString;
-                                uint32_t urlStatus = thunderPlugin->Get<WPEFramework::Core::JSON::String>(RDKSHELL_THUNDER_TIMEOUT, "url",urlString);
+                    if (stateStatus == 0)
+                    {
+                        WPEFramework::Core::JSON::String urlString;
+                        uint32_t urlStatus = thunderPlugin.Get<WPEFramework::Core::JSON::String>(RDKSHELL_THUNDER_TIMEOUT, "url",urlString);
 
-                                JsonObject typeObject;
-                                typeObject["callsign"] = callsign;
-                                typeObject["state"] = stateString.Value();
-                                if (urlStatus == 0)
-                                {
-                                    typeObject["uri"] = urlString.Value();
-                                }
-                                else
-                                {
-                                    typeObject["uri"] = "";
-                                }
-                                stateArray.Add(typeObject);
-                            }
+                        JsonObject typeObject;
+                        typeObject["callsign"] = callsign;
+                        typeObject["state"] = stateString.Value();
+                        if (urlStatus == 0)
+                        {
+                            typeObject["uri"] = urlString.Value();
+                        }
+                        else
+                        {
+                            typeObject["uri"] = "";
                         }
+                        stateArray.Add(typeObject);
                     }
                 }
             }
-            response["state"] = stateArray;
-
-            returnResponse(result);
         }
 
         uint32_t RDKShell::getSystemMemoryWrapper(const JsonObject& parameters, JsonObject& response)
@@ -4044,48 +5556,20 @@ namespace WPEFramework {
 
             JsonArray memoryInfo;
 
-            string method = "status";
-            Core::JSON::ArrayType<PluginHost::MetaData::Service> joResult;
-            auto thunderController = getThunderControllerClient();
-            uint32_t status = thunderController->Get<Core::JSON::ArrayType<PluginHost::MetaData::Service>>(RDKSHELL_THUNDER_TIMEOUT, method.c_str(), joResult);
+            std::map<std::string, PluginStatusData> pluginStatus;
+            getPluginStatus(mCurrentService, pluginStatus);
 
-            /*std::cout << "DEACTIVATED: " << PluginHost::MetaData::Service::state::DEACTIVATED << std::endl;
-                    std::cout << "DEACTIVATION: " << PluginHost::MetaData::Service::state::DEACTIVATION << std::endl;
-                    std::cout << "ACTIVATED: " << PluginHost::MetaData::Service::state::ACTIVATED << std::endl;
-                    std::cout << "ACTIVATION: " << PluginHost::MetaData::Service::state::ACTIVATION << std::endl;
-                    std::cout << "DESTROYED: " << PluginHost::MetaData::Service::state::DESTROYED << std::endl;
-                    std::cout << "PRECONDITION: " << PluginHost::MetaData::Service::state::PRECONDITION << std::endl;
-                    std::cout << "SUSPENDED: " << PluginHost::MetaData::Service::state::SUSPENDED << std::endl;
-                    std::cout << "RESUMED: " << PluginHost::MetaData::Service::state::RESUMED << std::endl;*/
-
-            JsonArray stateArray;
-            for (uint16_t i = 0; i < joResult.Length(); i++)
+            for (auto statusEntry = pluginStatus.begin(); statusEntry != pluginStatus.end(); statusEntry++)
             {
-                PluginHost::MetaData::Service service = joResult[i];
-                if (service.JSONState != PluginHost::MetaData::Service::state::DEACTIVATED &&
-                    service.JSONState != PluginHost::MetaData::Service::state::DEACTIVATION &&
-                    service.JSONState != PluginHost::MetaData::Service::state::PRECONDITION)
+                if (isPluginStatusActive(statusEntry->second) && statusEntry->second.mHasClientIdentifier)
                 {
-                    std::string configLine;
-                    service.Configuration.ToString(configLine);
-                    if (!configLine.empty())
-                    {
-                        JsonObject serviceConfig = JsonObject(configLine.c_str());
-                        if (serviceConfig.HasLabel("clientidentifier"))
-                        {
-                            std::string callsign;
-                            service.Callsign.ToString(callsign);
-                            callsign.erase(std::remove(callsign.begin(),callsign.end(),'\"'),callsign.end());
-
-                            WPEFramework::Core::JSON::String stateString;
-                            const string callsignWithVersion = callsign + ".1";
-                            uint32_t stateStatus = getThunderControllerClient(callsignWithVersion)->Get<WPEFramework::Core::JSON::String>(RDKSHELL_THUNDER_TIMEOUT, "state", stateString);
+                    const std::string& callsign = statusEntry->first;
+                    WPEFramework::Core::JSON::String stateString;
+                    uint32_t stateStatus = JSONRPCDirectLink(mCurrentService, callsign).Get<WPEFramework::Core::JSON::String>(RDKSHELL_THUNDER_TIMEOUT, "state", stateString);
 
-                            if (stateStatus == 0)
-                            {
-                                result = pluginMemoryUsage(callsign, memoryInfo);
-                            }
-                        }
+                    if (stateStatus == 0)
+                    {
+                        result = pluginMemoryUsage(callsign, memoryInfo);
                     }
                 }
             }
@@ -4116,6 +5600,9 @@ namespace WPEFramework {
               if (parameters.HasLabel("lowRam"))
               {
                 configuration["lowRam"] = std::stod(parameters["lowRam"].String());
+                gPrewarmMutex.lock();
+                gLowRamThresholdMb = std::stod(parameters["lowRam"].String());
+                gPrewarmMutex.unlock();
               }
               if (parameters.HasLabel("criticallyLowRam"))
               {
@@ -4389,17 +5876,16 @@ namespace WPEFramework {
                 }
             }
             setVisibility("factoryapp", false);
-            std::cout << "RDKShell sending onWillDestroyEvent for factoryapp" << std::endl;
-            JsonObject params;
-            params["callsign"] = "factoryapp";
-            notify(RDKSHELL_EVENT_ON_WILL_DESTROY, params);
-            sleep(gWillDestroyEventWaitTime);
-
-            killAllApps();
-            //try to kill factoryapp once more if kill apps missed killing due to timeout
-            JsonObject destroyRequest, destroyResponse;
-            destroyRequest["callsign"] = "factoryapp";
-            uint32_t result = destroyWrapper(destroyRequest, destroyResponse);
+            std::vector<std::string> callsigns;
+            getRunningApps(callsigns);
+            //factoryapp is destroyed even if its state could not be read
+            if (std::find(callsigns.begin(), callsigns.end(), "factoryapp") == callsigns.end())
+            {
+                callsigns.push_back("factoryapp");
+            }
+            std::set<std::string> willDestroyCallsigns;
+            willDestroyCallsigns.insert("factoryapp");
+            destroyApps(callsigns, willDestroyCallsigns);
 
             std::cout << "attempting to stop hdmi input...\n";
             JsonObject joStopHdmiParams;
@@ -4803,9 +6289,21 @@ namespace WPEFramework {
         {
             LOGINFOMETHOD();
             bool result = true;
-            lockRdkShellMutex();
-            needsScreenshot = true;
-            gRdkShellMutex.unlock();
+            ScreenshotRequest request;
+            request.format = parameters.HasLabel("format") ? parameters["format"].String() : "raw";
+            request.width = parameters.HasLabel("width") ? parameters["width"].Number() : 0;
+            request.height = parameters.HasLabel("height") ? parameters["height"].Number() : 0;
+            if (!isScreenshotFormatSupported(request.format))
+            {
+                response["message"] = "unsupported screenshot format";
+                result = false;
+            }
+            else
+            {
+                lockRdkShellMutex();
+                gScreenshotRequests.push_back(request);
+                unlockRdkShellMutex();
+            }
             returnResponse(result);
         }
         // Registered methods end
@@ -4918,91 +6416,329 @@ namespace WPEFramework {
 
         void RDKShell::killAllApps(bool enableDestroyEvent)
         {
-            bool ret = false;
-            JsonObject stateRequest, stateResponse;
-            uint32_t result = getState(stateRequest, stateResponse);
-            const JsonArray stateList = stateResponse.HasLabel("state")?stateResponse["state"].Array():JsonArray();
-
+            std::vector<std::string> callsigns;
+            getRunningApps(callsigns);
+            std::set<std::string> willDestroyCallsigns;
             if (enableDestroyEvent)
             {
-                for (int i=0; i<stateList.Length(); i++)
+                willDestroyCallsigns.insert(callsigns.begin(), callsigns.end());
+            }
+            destroyApps(callsigns, willDestroyCallsigns);
+        }
+
+        // one pass of the prewarm thread: destroys warm instances when ram is low or they left the pool, otherwise
+        // warms up the next app of the pool once no launch happened for gPrewarmIdleTime seconds
+        void RDKShell::prewarmApps()
+        {
+            std::vector<std::string> evictList;
+            PrewarmApp nextApp;
+            bool warmUp = false;
+            double lowRamThresholdMb = 0;
+            {
+                std::lock_guard<std::mutex> lock(gPrewarmMutex);
+                if (gPrewarmEvictRequested || gLowRamWarningActive)
                 {
-                    const JsonObject& stateInfo = stateList[i].Object();
-                    if (stateInfo.HasLabel("callsign"))
+                    for (auto callsign = gPrewarmedApps.begin(); callsign != gPrewarmedApps.end(); callsign++)
                     {
-                        const string callsign = stateInfo["callsign"].String();
-                        std::cout << "RDKShell sending onWillDestroyEvent for " << callsign << std::endl;
-                        JsonObject params;
-                        params["callsign"] = callsign;
-                        notify(RDKSHELL_EVENT_ON_WILL_DESTROY, params);
+                        bool inPool = false;
+                        for (size_t i = 0; i < gPrewarmApps.size(); i++)
+                        {
+                            inPool = inPool || (gPrewarmApps[i].callsign == *callsign);
+                        }
+                        if (gLowRamWarningActive || !inPool)
+                        {
+                            evictList.push_back(*callsign);
+                        }
+                    }
+                    gPrewarmEvictRequested = false;
+                }
+                else if (!gPrewarmApps.empty() && !sFactoryModeStart && (RdkShell::seconds() - gLastLaunchTime) >= gPrewarmIdleTime)
+                {
+                    for (size_t i = 0; i < gPrewarmApps.size(); i++)
+                    {
+                        if (gPrewarmedApps.find(gPrewarmApps[i].callsign) == gPrewarmedApps.end())
+                        {
+                            PluginStatusData statusData;
+                            bool running = findPluginStatus(mCurrentService, gPrewarmApps[i].callsign, statusData) && isPluginStatusActive(statusData);
+                            if (!running)
+                            {
+                                nextApp = gPrewarmApps[i];
+                                warmUp = true;
+                                break;
+                            }
+                        }
                     }
+                    lowRamThresholdMb = gLowRamThresholdMb;
+                }
+            }
+
+            for (size_t i = 0; i < evictList.size(); i++)
+            {
+                std::cout << "destroying prewarmed instance of " << evictList[i] << std::endl;
+                std::string message;
+                destroyApp(evictList[i], message);
+            }
+
+            if (warmUp)
+            {
+                // leave room for the warm instance above the low ram threshold so it does not trigger its own eviction
+                uint32_t freeKb = 0, totalKb = 0, usedSwapKb = 0;
+                if (lowRamThresholdMb > 0 && systemMemory(freeKb, totalKb, usedSwapKb) && (freeKb / 1024.0) < (2 * lowRamThresholdMb))
+                {
+                    std::cout << "not enough free ram to prewarm " << nextApp.callsign << std::endl;
+                    return;
+                }
+                gLaunchDestroyMutex.lock();
+                bool launchInProgress = !gLaunchApplications.empty();
+                gLaunchDestroyMutex.unlock();
+                if (launchInProgress)
+                {
+                    return;
+                }
+                std::cout << "prewarming " << nextApp.callsign << " of type " << nextApp.type << std::endl;
+                JsonObject launchRequest, launchResponse;
+                launchRequest["callsign"] = nextApp.callsign;
+                if (nextApp.type != nextApp.callsign)
+                {
+                    launchRequest["type"] = nextApp.type;
+                }
+                if (!nextApp.uri.empty())
+                {
+                    launchRequest["uri"] = nextApp.uri;
+                }
+                launchRequest["suspend"] = true;
+                launchRequest["visible"] = false;
+                launchRequest["focused"] = false;
+                launchApp(launchRequest, launchResponse, true);
+                if (launchResponse.HasLabel("success") && launchResponse["success"].Boolean())
+                {
+                    std::lock_guard<std::mutex> lock(gPrewarmMutex);
+                    gPrewarmedApps.insert(nextApp.callsign);
+                }
+                else
+                {
+                    std::cout << "unable to prewarm " << nextApp.callsign << std::endl;
+                }
+            }
+        }
+
+        // destroys suspended and hidden apps, least recently focused and largest first, until free memory is back
+        // above the low ram threshold. without a threshold one app is evicted per low ram warning
+        void RDKShell::evictApps()
+        {
+            struct EvictionCandidate
+            {
+                std::string callsign;
+                std::string state;
+                double lastForegroundTime;
+                int64_t residentKb;
+            };
+
+            std::set<std::string> protectedApps;
+            double lowRamThresholdMb = 0;
+            {
+                std::lock_guard<std::mutex> lock(gPrewarmMutex);
+                if (!gEvictionEnabled || !gEvictionRequested)
+                {
+                    return;
+                }
+                gEvictionRequested = false;
+                protectedApps = gEvictionProtectedApps;
+                protectedApps.insert(gEvictionConfiguredProtectedApps.begin(), gEvictionConfiguredProtectedApps.end());
+                lowRamThresholdMb = gLowRamThresholdMb;
+            }
+
+            std::string focusedClient;
+            runRdkShellCommand([&]() {
+                return CompositorController::getFocused(focusedClient);
+            });
+
+            JsonArray stateList;
+            getAppStates(stateList);
+            std::vector<EvictionCandidate> candidates;
+            for (int i=0; i<stateList.Length(); i++)
+            {
+                const JsonObject& stateInfo = stateList[i].Object();
+                EvictionCandidate candidate;
+                candidate.callsign = stateInfo["callsign"].String();
+                candidate.state = stateInfo["state"].String();
+                if (protectedApps.find(candidate.callsign) != protectedApps.end() ||
+                    toLower(candidate.callsign) == focusedClient)
+                {
+                    continue;
+                }
+                bool visible = true;
+                if (candidate.state != "suspended" && getVisibility(candidate.callsign, visible) && visible)
+                {
+                    continue;
+                }
+                gLastForegroundTimeMutex.lock();
+                auto lastForegroundTime = gLastForegroundTime.find(toLower(candidate.callsign));
+                candidate.lastForegroundTime = (lastForegroundTime != gLastForegroundTime.end()) ? lastForegroundTime->second : 0;
+                gLastForegroundTimeMutex.unlock();
+                candidate.residentKb = -1;
+                Exchange::IMemory* pluginMemoryInterface(mCurrentService->QueryInterfaceByCallsign<Exchange::IMemory>(candidate.callsign.c_str()));
+                if (nullptr != pluginMemoryInterface)
+                {
+                    candidate.residentKb = pluginMemoryInterface->Resident()/1024;
+                    pluginMemoryInterface->Release();
+                }
+                candidates.push_back(candidate);
+            }
+
+            std::sort(candidates.begin(), candidates.end(), [](const EvictionCandidate& first, const EvictionCandidate& second) {
+                if (first.lastForegroundTime != second.lastForegroundTime)
+                {
+                    return first.lastForegroundTime < second.lastForegroundTime;
+                }
+                return first.residentKb > second.residentKb;
+            });
+
+            const double now = RdkShell::seconds();
+            for (size_t i = 0; i < candidates.size(); i++)
+            {
+                uint32_t freeKb = 0, totalKb = 0, usedSwapKb = 0;
+                const bool hasMemory = systemMemory(freeKb, totalKb, usedSwapKb);
+                const bool recovered = (lowRamThresholdMb > 0) ? (hasMemory && (freeKb / 1024.0) >= lowRamThresholdMb) : (i > 0);
+                if (recovered)
+                {
+                    break;
+                }
+                std::cout << "evicting " << candidates[i].callsign << " to free memory, free ram is " << freeKb << "kb\n";
+                std::string message;
+                if (!destroyApp(candidates[i].callsign, message))
+                {
+                    std::cout << "unable to evict " << candidates[i].callsign << std::endl;
+                    continue;
+                }
+                JsonObject eventData;
+                eventData["callsign"] = candidates[i].callsign;
+                eventData["state"] = candidates[i].state;
+                eventData["action"] = "destroy";
+                eventData["ram"] = candidates[i].residentKb;
+                eventData["lastForeground"] = (candidates[i].lastForegroundTime > 0) ? (int64_t)(now - candidates[i].lastForegroundTime) : -1;
+                if (systemMemory(freeKb, totalKb, usedSwapKb))
+                {
+                    eventData["freeRam"] = freeKb;
                 }
-                sleep(1);
+                notify(RDKSHELL_EVENT_ON_APP_EVICTED, eventData);
             }
+        }
 
+        void RDKShell::getRunningApps(std::vector<std::string>& callsigns)
+        {
+            JsonArray stateList;
+            getAppStates(stateList);
             for (int i=0; i<stateList.Length(); i++)
             {
                 const JsonObject& stateInfo = stateList[i].Object();
                 if (stateInfo.HasLabel("callsign"))
                 {
-                   JsonObject destroyRequest, destroyResponse;
-                   destroyRequest["callsign"] = stateInfo["callsign"].String();
-                   result = destroyWrapper(destroyRequest, destroyResponse);
+                    callsigns.push_back(stateInfo["callsign"].String());
                 }
             }
         }
 
+        // every app is destroyed on its own thread. apps in willDestroyCallsigns are sent onWillDestroy first
+        // and destroyed once they acknowledge it or deactivate, or when gWillDestroyEventWaitTime expires
+        void RDKShell::destroyApps(const std::vector<std::string>& callsigns, const std::set<std::string>& willDestroyCallsigns)
+        {
+            gWillDestroyMutex.lock();
+            for (auto callsign = willDestroyCallsigns.begin(); callsign != willDestroyCallsigns.end(); callsign++)
+            {
+                gWillDestroyPending.insert(*callsign);
+                gWillDestroyCompleted.erase(*callsign);
+            }
+            gWillDestroyMutex.unlock();
+            for (auto callsign = willDestroyCallsigns.begin(); callsign != willDestroyCallsigns.end(); callsign++)
+            {
+                std::cout << "RDKShell sending onWillDestroyEvent for " << *callsign << std::endl;
+                JsonObject params;
+                params["callsign"] = *callsign;
+                notify(RDKSHELL_EVENT_ON_WILL_DESTROY, params);
+            }
+
+            const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(gWillDestroyEventWaitTime);
+            std::vector<std::thread> destroyThreads;
+            for (size_t i = 0; i < callsigns.size(); i++)
+            {
+                const std::string callsign = callsigns[i];
+                const bool waitForApp = (willDestroyCallsigns.find(callsign) != willDestroyCallsigns.end());
+                destroyThreads.push_back(std::thread([this, callsign, waitForApp, deadline]() {
+                    if (waitForApp)
+                    {
+                        std::unique_lock<std::mutex> lock(gWillDestroyMutex);
+                        if (!gWillDestroyCondition.wait_until(lock, deadline, [&callsign]{ return gWillDestroyCompleted.find(callsign) != gWillDestroyCompleted.end(); }))
+                        {
+                            std::cout << callsign << " did not acknowledge onWillDestroy in time" << std::endl;
+                        }
+                        gWillDestroyPending.erase(callsign);
+                        gWillDestroyCompleted.erase(callsign);
+                    }
+                    std::string message;
+                    destroyApp(callsign, message);
+                }));
+            }
+            for (size_t i = 0; i < destroyThreads.size(); i++)
+            {
+                destroyThreads[i].join();
+            }
+
+            gWillDestroyMutex.lock();
+            for (auto callsign = willDestroyCallsigns.begin(); callsign != willDestroyCallsigns.end(); callsign++)
+            {
+                gWillDestroyPending.erase(*callsign);
+                gWillDestroyCompleted.erase(*callsign);
+            }
+            gWillDestroyMutex.unlock();
+        }
+
         // Internal methods begin
 
         bool RDKShell::moveToFront(const string& client)
         {
-            bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::moveToFront(client);
-            gRdkShellMutex.unlock();
-            return ret;
+            return runRdkShellCommand([&]() {
+                return CompositorController::moveToFront(client);
+            });
         }
 
         bool RDKShell::moveToBack(const string& client)
         {
-            bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::moveToBack(client);
-            gRdkShellMutex.unlock();
-            return ret;
+            return runRdkShellCommand([&]() {
+                return CompositorController::moveToBack(client);
+            });
         }
 
         bool RDKShell::moveBehind(const string& client, const string& target)
         {
-            bool ret = false;
-            lockRdkShellMutex();
-            std::vector<std::string> clientList;
-            CompositorController::getClients(clientList);
-            bool targetFound = false;
-            for (size_t i=0; i<clientList.size(); i++)
-            {
-                if (strcasecmp(clientList[i].c_str(),target.c_str()) == 0)
+            return runRdkShellCommand([&]() {
+                std::vector<std::string> clientList;
+                CompositorController::getClients(clientList);
+                bool targetFound = false;
+                for (size_t i=0; i<clientList.size(); i++)
                 {
-                    targetFound = true;
-                    break;
+                    if (strcasecmp(clientList[i].c_str(),target.c_str()) == 0)
+                    {
+                        targetFound = true;
+                        break;
+                    }
                 }
-            }
-            if (targetFound)
-            {
-                ret = CompositorController::moveBehind(client, target);
-            }
-            gRdkShellMutex.unlock();
-            return ret;
+                if (targetFound)
+                {
+                    return CompositorController::moveBehind(client, target);
+                }
+                return false;
+            });
         }
 
         bool RDKShell::setFocus(const string& client)
         {
             bool ret = false;
             std::string previousFocusedClient;
-            lockRdkShellMutex();
-            CompositorController::getFocused(previousFocusedClient);
-            ret = CompositorController::setFocus(client);
-            gRdkShellMutex.unlock();
+            ret = runRdkShellCommand([&]() {
+                CompositorController::getFocused(previousFocusedClient);
+                return CompositorController::setFocus(client);
+            });
 
             std::string clientLower = toLower(client);
 
@@ -5056,12 +6792,10 @@ namespace WPEFramework {
 
         bool RDKShell::kill(const string& client)
         {
-            bool ret = false;
-            lockRdkShellMutex();
-            RdkShell::CompositorController::removeListener(client, mEventListener);
-            ret = CompositorController::kill(client);
-            gRdkShellMutex.unlock();
-            return ret;
+            return runRdkShellCommand([&]() {
+                RdkShell::CompositorController::removeListener(client, mEventListener);
+                return CompositorController::kill(client);
+            });
         }
 
         bool RDKShell::addKeyIntercept(const uint32_t& keyCode, const JsonArray& modifiers, const string& client)
@@ -5071,9 +6805,9 @@ namespace WPEFramework {
               flags |= getKeyFlag(modifiers[i].String());
             }
             bool ret = false;
-            gRdkShellMutex.lock();
+            lockRdkShellMutex();
             ret = CompositorController::addKeyIntercept(client, keyCode, flags);
-            gRdkShellMutex.unlock();
+            unlockRdkShellMutex();
             return ret;
         }
 
@@ -5084,15 +6818,15 @@ namespace WPEFramework {
               flags |= getKeyFlag(modifiers[i].String());
             }
             bool ret = false;
-            gRdkShellMutex.lock();
+            lockRdkShellMutex();
             ret = CompositorController::removeKeyIntercept(client, keyCode, flags);
-            gRdkShellMutex.unlock();
+            unlockRdkShellMutex();
             return ret;
         }
 
         bool RDKShell::addKeyListeners(const string& client, const JsonArray& keys)
         {
-            gRdkShellMutex.lock();
+            lockRdkShellMutex();
 
             bool result = true;
 
@@ -5169,13 +6903,13 @@ namespace WPEFramework {
                     break;
                 }
             }
-            gRdkShellMutex.unlock();
+            unlockRdkShellMutex();
             return result;
         }
 
         bool RDKShell::removeKeyListeners(const string& client, const JsonArray& keys)
         {
-            gRdkShellMutex.lock();
+            lockRdkShellMutex();
 
             bool result = true;
 
@@ -5241,7 +6975,7 @@ namespace WPEFramework {
                     break;
                 }
             }
-            gRdkShellMutex.unlock();
+            unlockRdkShellMutex();
             return result;
         }
 
@@ -5252,47 +6986,151 @@ namespace WPEFramework {
             for (int i=0; i<modifiers.Length(); i++) {
               flags |= getKeyFlag(modifiers[i].String());
             }
-            gRdkShellMutex.lock();
+            lockRdkShellMutex();
             ret = CompositorController::injectKey(keyCode, flags);
-            gRdkShellMutex.unlock();
+            unlockRdkShellMutex();
+            return ret;
+        }
+
+        bool RDKShell::generateKey(const string& client, const JsonArray& keyInputs)
+        {
+            bool ret = false;
+            for (int i=0; i<keyInputs.Length(); i++) {
+                const JsonObject& keyInputInfo = keyInputs[i].Object();
+                if (keyInputInfo.HasLabel("keyCode"))
+                {
+                  const uint32_t keyCode = keyInputInfo["keyCode"].Number();
+                  const uint32_t delay = keyInputInfo["delay"].Number();
+                  sleep(delay);
+                  const JsonArray modifiers = keyInputInfo.HasLabel("modifiers") ? keyInputInfo["modifiers"].Array() : JsonArray();
+                  std::string keyClient = keyInputInfo.HasLabel("client")? keyInputInfo["client"].String(): client;
+                  if (keyClient.empty())
+                  {
+                    keyClient = keyInputInfo.HasLabel("callsign")? keyInputInfo["callsign"].String(): "";
+                  }
+                  uint32_t flags = 0;
+                  for (int k=0; k<modifiers.Length(); k++) {
+                    flags |= getKeyFlag(modifiers[k].String());
+                  }
+                  lockRdkShellMutex();
+                  ret = CompositorController::generateKey(keyClient, keyCode, flags);
+                  unlockRdkShellMutex();
+                }
+            }
             return ret;
         }
 
-        bool RDKShell::generateKey(const string& client, const JsonArray& keyInputs)
-        {
-            bool ret = false;
-            for (int i=0; i<keyInputs.Length(); i++) {
-                const JsonObject& keyInputInfo = keyInputs[i].Object();
-                if (keyInputInfo.HasLabel("keyCode"))
+        bool RDKShell::scheduleKeySequence(const string& client, const JsonArray& keyInputs, uint32_t& sequenceId)
+        {
+            KeySequence sequence;
+            parseKeyInputs(client, keyInputs, sequence.keys);
+            if (sequence.keys.empty())
+            {
+                return false;
+            }
+            sequence.nextKey = 0;
+            sequence.failedKeys = 0;
+            sequence.startTime = std::chrono::steady_clock::now();
+            std::lock_guard<std::mutex> lock(gKeySequenceMutex);
+            sequenceId = gNextKeySequenceId++;
+            gKeySequences[sequenceId] = sequence;
+            gKeySequenceCondition.notify_one();
+            return true;
+        }
+
+        bool RDKShell::cancelKeySequence(const uint32_t sequenceId)
+        {
+            JsonObject eventData;
+            {
+                std::lock_guard<std::mutex> lock(gKeySequenceMutex);
+                auto sequence = gKeySequences.find(sequenceId);
+                if (sequence == gKeySequences.end())
+                {
+                    return false;
+                }
+                eventData["sequenceId"] = sequenceId;
+                eventData["success"] = false;
+                eventData["cancelled"] = true;
+                eventData["keysInjected"] = (uint32_t)sequence->second.nextKey;
+                eventData["keysTotal"] = (uint32_t)sequence->second.keys.size();
+                gKeySequences.erase(sequence);
+                gKeySequenceCondition.notify_one();
+            }
+            notify(RDKSHELL_EVENT_ON_KEY_SEQUENCE_COMPLETE, eventData);
+            return true;
+        }
+
+        // injects the next due key of all pending sequences, sleeping until the earliest one is due
+        void RDKShell::runKeySequences()
+        {
+            std::unique_lock<std::mutex> lock(gKeySequenceMutex);
+            while (gKeySequenceThreadRunning)
+            {
+                if (gKeySequences.empty())
+                {
+                    gKeySequenceCondition.wait(lock);
+                    continue;
+                }
+                auto nextSequence = gKeySequences.end();
+                std::chrono::steady_clock::time_point nextDueTime;
+                for (auto sequence = gKeySequences.begin(); sequence != gKeySequences.end(); sequence++)
+                {
+                    std::chrono::steady_clock::time_point dueTime = sequence->second.startTime +
+                        std::chrono::milliseconds(sequence->second.keys[sequence->second.nextKey].offsetInMs);
+                    if (nextSequence == gKeySequences.end() || dueTime < nextDueTime)
+                    {
+                        nextSequence = sequence;
+                        nextDueTime = dueTime;
+                    }
+                }
+                if (nextDueTime > std::chrono::steady_clock::now())
+                {
+                    gKeySequenceCondition.wait_until(lock, nextDueTime);
+                    continue;
+                }
+
+                const uint32_t sequenceId = nextSequence->first;
+                const ScheduledKey key = nextSequence->second.keys[nextSequence->second.nextKey];
+                lock.unlock();
+                lockRdkShellMutex();
+                bool ret = CompositorController::generateKey(key.client, key.keyCode, key.flags);
+                unlockRdkShellMutex();
+                lock.lock();
+
+                // the sequence may have been cancelled while the key was injected
+                auto sequence = gKeySequences.find(sequenceId);
+                if (sequence == gKeySequences.end())
                 {
-                  const uint32_t keyCode = keyInputInfo["keyCode"].Number();
-                  const uint32_t delay = keyInputInfo["delay"].Number();
-                  sleep(delay);
-                  const JsonArray modifiers = keyInputInfo.HasLabel("modifiers") ? keyInputInfo["modifiers"].Array() : JsonArray();
-                  std::string keyClient = keyInputInfo.HasLabel("client")? keyInputInfo["client"].String(): client;
-                  if (keyClient.empty())
-                  {
-                    keyClient = keyInputInfo.HasLabel("callsign")? keyInputInfo["callsign"].String(): "";
-                  }
-                  uint32_t flags = 0;
-                  for (int k=0; k<modifiers.Length(); k++) {
-                    flags |= getKeyFlag(modifiers[k].String());
-                  }
-                  gRdkShellMutex.lock();
-                  ret = CompositorController::generateKey(keyClient, keyCode, flags);
-                  gRdkShellMutex.unlock();
+                    continue;
+                }
+                sequence->second.nextKey++;
+                if (!ret)
+                {
+                    sequence->second.failedKeys++;
+                }
+                if (sequence->second.nextKey >= sequence->second.keys.size())
+                {
+                    JsonObject eventData;
+                    eventData["sequenceId"] = sequenceId;
+                    eventData["success"] = (sequence->second.failedKeys == 0);
+                    eventData["cancelled"] = false;
+                    eventData["keysInjected"] = (uint32_t)sequence->second.nextKey;
+                    eventData["keysTotal"] = (uint32_t)sequence->second.keys.size();
+                    gKeySequences.erase(sequence);
+                    lock.unlock();
+                    notify(RDKSHELL_EVENT_ON_KEY_SEQUENCE_COMPLETE, eventData);
+                    lock.lock();
                 }
             }
-            return ret;
         }
 
         bool RDKShell::getScreenResolution(JsonObject& out)
         {
             unsigned int width=0,height=0;
             bool ret = false;
-            lockRdkShellMutex();
+            lockRdkShellMutexForRead();
             ret = CompositorController::getScreenResolution(width, height);
-            gRdkShellMutex.unlock();
+            unlockRdkShellMutex();
             if (true == ret) {
               out["w"] = width;
               out["h"] = height;
@@ -5307,7 +7145,7 @@ namespace WPEFramework {
             receivedResolutionRequest = true;
             resolutionWidth = w;
             resolutionHeight = h;
-            gRdkShellMutex.unlock();
+            unlockRdkShellMutex();
             return true;
         }
 
@@ -5316,16 +7154,16 @@ namespace WPEFramework {
             bool ret = false;
             lockRdkShellMutex();
             ret = CompositorController::setMimeType(client, mimeType);
-            gRdkShellMutex.unlock();
+            unlockRdkShellMutex();
             return ret;
         }
 
         bool RDKShell::getMimeType(const string& client, string& mimeType)
         {
             bool ret = false;
-            lockRdkShellMutex();
+            lockRdkShellMutexForRead();
             ret = CompositorController::getMimeType(client, mimeType);
-            gRdkShellMutex.unlock();
+            unlockRdkShellMutex();
             return ret;
         }
 
@@ -5333,20 +7171,29 @@ namespace WPEFramework {
             const bool virtualDisplay, const uint32_t virtualWidth, const uint32_t virtualHeight)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::createDisplay(client, displayName, displayWidth, displayHeight,
-                virtualDisplay, virtualWidth, virtualHeight);
-            RdkShell::CompositorController::addListener(client, mEventListener);
-            gRdkShellMutex.unlock();
+            ret = runRdkShellCommand([&]() {
+                bool created = CompositorController::createDisplay(client, displayName, displayWidth, displayHeight,
+                    virtualDisplay, virtualWidth, virtualHeight);
+                RdkShell::CompositorController::addListener(client, mEventListener);
+                return created;
+            });
             return ret;
         }
 
         bool RDKShell::getClients(JsonArray& clients)
         {
             std::vector<std::string> clientList;
-            lockRdkShellMutex();
-            CompositorController::getClients(clientList);
-            gRdkShellMutex.unlock();
+            std::shared_ptr<const RdkShellSnapshot> snapshot = getRdkShellSnapshot();
+            if (snapshot)
+            {
+                clientList = snapshot->clients;
+            }
+            else
+            {
+                lockRdkShellMutexForRead();
+                CompositorController::getClients(clientList);
+                unlockRdkShellMutex();
+            }
             for (size_t i=0; i<clientList.size(); i++) {
               clients.Add(clientList[i]);
             }
@@ -5356,9 +7203,17 @@ namespace WPEFramework {
         bool RDKShell::getZOrder(JsonArray& clients)
         {
             std::vector<std::string> zOrderList;
-            lockRdkShellMutex();
-            CompositorController::getZOrder(zOrderList);
-            gRdkShellMutex.unlock();
+            std::shared_ptr<const RdkShellSnapshot> snapshot = getRdkShellSnapshot();
+            if (snapshot)
+            {
+                zOrderList = snapshot->zOrder;
+            }
+            else
+            {
+                lockRdkShellMutexForRead();
+                CompositorController::getZOrder(zOrderList);
+                unlockRdkShellMutex();
+            }
             for (size_t i=0; i<zOrderList.size(); i++) {
               clients.Add(zOrderList[i]);
             }
@@ -5369,9 +7224,22 @@ namespace WPEFramework {
         {
             unsigned int x=0,y=0,width=0,height=0;
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::getBounds(client, x, y, width, height);
-            gRdkShellMutex.unlock();
+            std::shared_ptr<const RdkShellSnapshot> snapshot = getRdkShellSnapshot();
+            const RdkShellClientSnapshot* state = findClientSnapshot(snapshot, client);
+            if (state)
+            {
+                ret = state->hasBounds;
+                x = state->x;
+                y = state->y;
+                width = state->width;
+                height = state->height;
+            }
+            else
+            {
+                lockRdkShellMutexForRead();
+                ret = CompositorController::getBounds(client, x, y, width, height);
+                unlockRdkShellMutex();
+            }
             if (true == ret) {
               bounds["x"] = x;
               bounds["y"] = y;
@@ -5382,52 +7250,69 @@ namespace WPEFramework {
             return false;
         }
 
-        bool RDKShell::setBounds(const std::string& client, const unsigned int x, const unsigned int y, const unsigned int w, const unsigned int h)
+        bool RDKShell::setBounds(const std::string& client, const unsigned int x, const unsigned int y, const unsigned int w, const unsigned int h, const bool waitForFrame)
         {
             bool ret = false;
-            lockRdkShellMutex();
+            uint64_t fence = 0;
             std::cout << "setting the bounds\n";
-            ret = CompositorController::setBounds(client, 0, 0, 1, 1); //forcing a compositor resize flush
-            ret = CompositorController::setBounds(client, x, y, w, h);
-            gRdkShellMutex.unlock();
+            ret = runRdkShellCommand([&]() {
+                CompositorController::setBounds(client, 0, 0, 1, 1); //forcing a compositor resize flush
+                bool applied = CompositorController::setBounds(client, x, y, w, h);
+                if (applied)
+                {
+                    BoundsFence boundsFence;
+                    boundsFence.fence = fence = getRdkShellFrameFence();
+                    boundsFence.client = client;
+                    boundsFence.x = x;
+                    boundsFence.y = y;
+                    boundsFence.width = w;
+                    boundsFence.height = h;
+                    addBoundsFence(boundsFence);
+                }
+                return applied;
+            });
             std::cout << "bounds set\n";
-            usleep(68000);
-            std::cout << "all set\n";
+            if (ret && waitForFrame)
+            {
+                if (!waitForRdkShellFrameFence(fence))
+                {
+                    std::cout << "bounds of " << client << " not presented yet\n";
+                }
+            }
             return ret;
         }
 
         bool RDKShell::getVisibility(const string& client, bool& visible)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::getVisibility(client, visible);
-            gRdkShellMutex.unlock();
+            std::shared_ptr<const RdkShellSnapshot> snapshot = getRdkShellSnapshot();
+            const RdkShellClientSnapshot* state = findClientSnapshot(snapshot, client);
+            if (state)
+            {
+                ret = state->hasVisibility;
+                visible = state->visible;
+            }
+            else
+            {
+                lockRdkShellMutexForRead();
+                ret = CompositorController::getVisibility(client, visible);
+                unlockRdkShellMutex();
+            }
             return ret;
         }
 
         bool RDKShell::setVisibility(const string& client, const bool visible)
         {
             bool ret = false;
-            {
-                bool lockAcquired = false;
-                double startTime = RdkShell::milliseconds();
-                while (!lockAcquired && (RdkShell::milliseconds() - startTime) < RDKSHELL_TRY_LOCK_WAIT_TIME_IN_MS)
-                {
-                    lockAcquired = gRdkShellMutex.try_lock();
-                }
-                if (!lockAcquired)
-                {
-                    std::cout << "unable to get lock for visibility, defaulting to normal lock\n";
-                    gRdkShellMutex.lock();
-                }
-                else
-                {
-                    std::cout << "lock was acquired via try for visibility\n";
-                }
-            }
-            ret = CompositorController::setVisibility(client, visible);
-            gRdkShellMutex.unlock();
+            ret = runRdkShellCommand([&]() {
+                return CompositorController::setVisibility(client, visible);
+            });
+            setBrowserVisibility(client, visible);
+            return ret;
+        }
 
+        void RDKShell::setBrowserVisibility(const string& client, const bool visible)
+        {
             std::map<std::string, PluginData> activePluginsData;
             gPluginDataMutex.lock();
             activePluginsData = gActivePluginsData;
@@ -5456,101 +7341,121 @@ namespace WPEFramework {
                     }
                 }
             }
-
-            return ret;
         }
 
         bool RDKShell::getOpacity(const string& client, unsigned int& opacity)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::getOpacity(client, opacity);
-            gRdkShellMutex.unlock();
-            return ret;
-        }
-
-        bool RDKShell::setOpacity(const string& client, const unsigned int opacity)
-        {
-             bool ret = false;
-            lockRdkShellMutex();
-            std::vector<std::string> clientList;
-            CompositorController::getClients(clientList);
-            bool targetFound = false;
-            std::string newClient(client);
-            std::transform(newClient.begin(), newClient.end(), newClient.begin(), ::tolower);
-            if (std::find(clientList.begin(), clientList.end(), newClient) != clientList.end())
+            std::shared_ptr<const RdkShellSnapshot> snapshot = getRdkShellSnapshot();
+            const RdkShellClientSnapshot* state = findClientSnapshot(snapshot, client);
+            if (state)
             {
-              targetFound = true;
-             }
-             if (targetFound)
+                ret = state->hasOpacity;
+                opacity = state->opacity;
+            }
+            else
             {
-            ret = CompositorController::setOpacity(newClient, opacity);
+                lockRdkShellMutexForRead();
+                ret = CompositorController::getOpacity(client, opacity);
+                unlockRdkShellMutex();
             }
-            gRdkShellMutex.unlock();
             return ret;
-
         }
 
-        bool RDKShell::getScale(const string& client, double& scaleX, double& scaleY)
+        bool RDKShell::setOpacity(const string& client, const unsigned int opacity)
         {
-            bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::getScale(client, scaleX, scaleY);
-            gRdkShellMutex.unlock();
-            return ret;
+            return runRdkShellCommand([&]() {
+                std::vector<std::string> clientList;
+                CompositorController::getClients(clientList);
+                std::string newClient(client);
+                std::transform(newClient.begin(), newClient.end(), newClient.begin(), ::tolower);
+                if (std::find(clientList.begin(), clientList.end(), newClient) != clientList.end())
+                {
+                    return CompositorController::setOpacity(newClient, opacity);
+                }
+                return false;
+            });
+
         }
 
-        bool RDKShell::setScale(const string& client, const double scaleX, const double scaleY)
+        bool RDKShell::getScale(const string& client, double& scaleX, double& scaleY)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            std::vector<std::string> clientList;
-            CompositorController::getClients(clientList);
-	    bool targetFound = false;
-            std::string newClient(client);
-            transform(newClient.begin(), newClient.end(), newClient.begin(), ::tolower);
-            if (std::find(clientList.begin(), clientList.end(), newClient) != clientList.end())
+            std::shared_ptr<const RdkShellSnapshot> snapshot = getRdkShellSnapshot();
+            const RdkShellClientSnapshot* state = findClientSnapshot(snapshot, client);
+            if (state)
             {
-              targetFound = true;
+                ret = state->hasScale;
+                scaleX = state->scaleX;
+                scaleY = state->scaleY;
             }
-            if (targetFound)
+            else
             {
-            ret = CompositorController::setScale(newClient, scaleX, scaleY);
+                lockRdkShellMutexForRead();
+                ret = CompositorController::getScale(client, scaleX, scaleY);
+                unlockRdkShellMutex();
             }
-            gRdkShellMutex.unlock();
             return ret;
         }
 
+        bool RDKShell::setScale(const string& client, const double scaleX, const double scaleY)
+        {
+            return runRdkShellCommand([&]() {
+                std::vector<std::string> clientList;
+                CompositorController::getClients(clientList);
+                std::string newClient(client);
+                transform(newClient.begin(), newClient.end(), newClient.begin(), ::tolower);
+                if (std::find(clientList.begin(), clientList.end(), newClient) != clientList.end())
+                {
+                    return CompositorController::setScale(newClient, scaleX, scaleY);
+                }
+                return false;
+            });
+        }
+
         bool RDKShell::getHolePunch(const string& client, bool& holePunch)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::getHolePunch(client, holePunch);
-            gRdkShellMutex.unlock();
+            std::shared_ptr<const RdkShellSnapshot> snapshot = getRdkShellSnapshot();
+            const RdkShellClientSnapshot* state = findClientSnapshot(snapshot, client);
+            if (state)
+            {
+                ret = state->hasHolePunch;
+                holePunch = state->holePunch;
+            }
+            else
+            {
+                lockRdkShellMutexForRead();
+                ret = CompositorController::getHolePunch(client, holePunch);
+                unlockRdkShellMutex();
+            }
             return ret;
         }
 
         bool RDKShell::setHolePunch(const string& client, const bool holePunch)
         {
-            bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::setHolePunch(client, holePunch);
-            gRdkShellMutex.unlock();
-            return ret;
+            return runRdkShellCommand([&]() {
+                return CompositorController::setHolePunch(client, holePunch);
+            });
         }
 
         bool RDKShell::removeAnimation(const string& client)
         {
-            bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::removeAnimation(client);
-            gRdkShellMutex.unlock();
-            return ret;
+            return runRdkShellCommand([&]() {
+                return CompositorController::removeAnimation(client);
+            });
         }
 
         bool RDKShell::addAnimationList(const JsonArray& animations)
         {
-            lockRdkShellMutex();
+            struct Animation
+            {
+                std::string client;
+                double duration;
+                std::map<std::string, RdkShellData> properties;
+            };
+            std::vector<Animation> animationList;
+            double animationTime = 0;
             for (int i=0; i<animations.Length(); i++) {
                 const JsonObject& animationInfo = animations[i].Object();
                 if (animationInfo.HasLabel("client") && animationInfo.HasLabel("duration"))
@@ -5598,30 +7503,273 @@ namespace WPEFramework {
                         std::string tween = animationInfo["tween"].String();
                         animationProperties["tween"] = tween;
                     }
+                    double animationDelay = 0;
                     if (animationInfo.HasLabel("delay"))
                     {
                         try
                         {
-                          double duration = std::stod(animationInfo["delay"].String());
-                          animationProperties["delay"] = duration;
+                          animationDelay = std::stod(animationInfo["delay"].String());
+                          animationProperties["delay"] = animationDelay;
                         }
                         catch (...)
                         {
                           std::cout << "RDKShell unable to set delay for animation  " << std::endl;
                         }
                     }
-                    CompositorController::addAnimation(client, duration, animationProperties);
+                    Animation animation;
+                    animation.client = client;
+                    animation.duration = duration;
+                    animation.properties = animationProperties;
+                    animationList.push_back(animation);
+                    animationTime = std::max(animationTime, (animationDelay + duration) * 1000);
                 }
             }
-            gRdkShellMutex.unlock();
+            runRdkShellCommand([&]() {
+                for (size_t i = 0; i < animationList.size(); i++)
+                {
+                    CompositorController::addAnimation(animationList[i].client, animationList[i].duration, animationList[i].properties);
+                }
+                gRdkShellAnimationUntil = std::max(gRdkShellAnimationUntil, RdkShell::milliseconds() + animationTime + RDKSHELL_SNAPSHOT_REFRESH_INTERVAL_IN_MS);
+                return true;
+            });
             return true;
         }
 
+        bool RDKShell::applyLayout(const JsonArray& layout, const bool waitForFrame)
+        {
+            struct LayoutChange
+            {
+                std::string callsign;
+                std::string client;
+                bool hasX, hasY, hasWidth, hasHeight;
+                uint32_t x, y, width, height;
+                bool hasOpacity;
+                uint32_t opacity;
+                bool hasVisible;
+                bool visible;
+                bool hasScaleX, hasScaleY;
+                double scaleX, scaleY;
+                bool hasHolePunch;
+                bool holePunch;
+                bool moveToFront;
+                bool moveToBack;
+                std::string behind;
+            };
+            std::vector<LayoutChange> changes;
+            for (int i=0; i<layout.Length(); i++) {
+                const JsonObject& layoutInfo = layout[i].Object();
+                LayoutChange change;
+                if (layoutInfo.HasLabel("client"))
+                {
+                    change.callsign = layoutInfo["client"].String();
+                }
+                else if (layoutInfo.HasLabel("callsign"))
+                {
+                    change.callsign = layoutInfo["callsign"].String();
+                }
+                else
+                {
+                    std::cout << "layout entry " << i << " does not specify a client\n";
+                    return false;
+                }
+                change.client = toLower(change.callsign);
+                change.hasX = layoutInfo.HasLabel("x");
+                change.x = change.hasX ? layoutInfo["x"].Number() : 0;
+                change.hasY = layoutInfo.HasLabel("y");
+                change.y = change.hasY ? layoutInfo["y"].Number() : 0;
+                change.hasWidth = layoutInfo.HasLabel("w");
+                change.width = change.hasWidth ? layoutInfo["w"].Number() : 0;
+                change.hasHeight = layoutInfo.HasLabel("h");
+                change.height = change.hasHeight ? layoutInfo["h"].Number() : 0;
+                change.hasOpacity = layoutInfo.HasLabel("opacity");
+                change.opacity = change.hasOpacity ? layoutInfo["opacity"].Number() : 100;
+                change.hasVisible = layoutInfo.HasLabel("visible");
+                change.visible = change.hasVisible ? layoutInfo["visible"].Boolean() : true;
+                change.hasScaleX = layoutInfo.HasLabel("sx");
+                change.hasScaleY = layoutInfo.HasLabel("sy");
+                change.scaleX = 1.0;
+                change.scaleY = 1.0;
+                try
+                {
+                    if (change.hasScaleX)
+                    {
+                        change.scaleX = std::stod(layoutInfo["sx"].String());
+                    }
+                    if (change.hasScaleY)
+                    {
+                        change.scaleY = std::stod(layoutInfo["sy"].String());
+                    }
+                }
+                catch(...)
+                {
+                    std::cout << "error decoding sx or sy for " << change.client << std::endl;
+                    return false;
+                }
+                change.hasHolePunch = layoutInfo.HasLabel("holePunch");
+                change.holePunch = change.hasHolePunch ? layoutInfo["holePunch"].Boolean() : true;
+                change.moveToFront = layoutInfo.HasLabel("moveToFront") && layoutInfo["moveToFront"].Boolean();
+                change.moveToBack = layoutInfo.HasLabel("moveToBack") && layoutInfo["moveToBack"].Boolean();
+                if (layoutInfo.HasLabel("behind"))
+                {
+                    change.behind = toLower(layoutInfo["behind"].String());
+                }
+                changes.push_back(change);
+            }
+
+            // every client is checked before anything is changed and the previous state of the changed clients is
+            // restored if any change fails, so that a layout is either applied as a whole or not at all. all of it
+            // is presented in the same frame
+            struct LayoutState
+            {
+                unsigned int x, y, width, height;
+                double scaleX, scaleY;
+                unsigned int opacity;
+                bool visible;
+                bool holePunch;
+            };
+            uint64_t fence = 0;
+            bool ret = runRdkShellCommand([&]() {
+                std::vector<std::string> clientList;
+                CompositorController::getClients(clientList);
+                bool changesZOrder = false;
+                for (size_t i = 0; i < changes.size(); i++)
+                {
+                    if (std::find(clientList.begin(), clientList.end(), changes[i].client) == clientList.end() ||
+                        (!changes[i].behind.empty() && std::find(clientList.begin(), clientList.end(), changes[i].behind) == clientList.end()))
+                    {
+                        std::cout << "unable to apply layout, client " << changes[i].client << " not found\n";
+                        return false;
+                    }
+                    changesZOrder = changesZOrder || changes[i].moveToFront || changes[i].moveToBack || !changes[i].behind.empty();
+                }
+                std::vector<std::string> zOrder;
+                if (changesZOrder)
+                {
+                    CompositorController::getZOrder(zOrder);
+                }
+                std::vector<LayoutState> previousStates(changes.size());
+                std::vector<BoundsFence> boundsFences;
+                fence = getRdkShellFrameFence();
+                bool applied = true;
+                size_t changed = 0;
+                for (; applied && changed < changes.size(); changed++)
+                {
+                    const LayoutChange& change = changes[changed];
+                    LayoutState& previousState = previousStates[changed];
+                    CompositorController::getBounds(change.client, previousState.x, previousState.y, previousState.width, previousState.height);
+                    CompositorController::getScale(change.client, previousState.scaleX, previousState.scaleY);
+                    CompositorController::getOpacity(change.client, previousState.opacity);
+                    CompositorController::getVisibility(change.client, previousState.visible);
+                    CompositorController::getHolePunch(change.client, previousState.holePunch);
+                    if (change.hasX || change.hasY || change.hasWidth || change.hasHeight)
+                    {
+                        BoundsFence boundsFence;
+                        boundsFence.fence = fence;
+                        boundsFence.client = change.client;
+                        boundsFence.x = change.hasX ? change.x : previousState.x;
+                        boundsFence.y = change.hasY ? change.y : previousState.y;
+                        boundsFence.width = change.hasWidth ? change.width : previousState.width;
+                        boundsFence.height = change.hasHeight ? change.height : previousState.height;
+                        CompositorController::setBounds(change.client, 0, 0, 1, 1); //forcing a compositor resize flush
+                        applied = CompositorController::setBounds(change.client, boundsFence.x, boundsFence.y, boundsFence.width, boundsFence.height) && applied;
+                        boundsFences.push_back(boundsFence);
+                    }
+                    if (change.hasScaleX || change.hasScaleY)
+                    {
+                        applied = CompositorController::setScale(change.client, change.hasScaleX ? change.scaleX : previousState.scaleX,
+                            change.hasScaleY ? change.scaleY : previousState.scaleY) && applied;
+                    }
+                    if (change.hasOpacity)
+                    {
+                        applied = CompositorController::setOpacity(change.client, change.opacity) && applied;
+                    }
+                    if (change.hasVisible)
+                    {
+                        applied = CompositorController::setVisibility(change.client, change.visible) && applied;
+                    }
+                    if (change.hasHolePunch)
+                    {
+                        applied = CompositorController::setHolePunch(change.client, change.holePunch) && applied;
+                    }
+                    if (change.moveToFront)
+                    {
+                        applied = CompositorController::moveToFront(change.client) && applied;
+                    }
+                    else if (change.moveToBack)
+                    {
+                        applied = CompositorController::moveToBack(change.client) && applied;
+                    }
+                    else if (!change.behind.empty())
+                    {
+                        applied = CompositorController::moveBehind(change.client, change.behind) && applied;
+                    }
+                }
+                if (!applied)
+                {
+                    std::cout << "unable to apply layout for " << changes[changed - 1].client << ", restoring the previous layout\n";
+                    // in reverse so that a client listed more than once ends up with the state it had before the layout
+                    while (changed-- > 0)
+                    {
+                        const LayoutChange& change = changes[changed];
+                        const LayoutState& previousState = previousStates[changed];
+                        if (change.hasX || change.hasY || change.hasWidth || change.hasHeight)
+                        {
+                            CompositorController::setBounds(change.client, 0, 0, 1, 1); //forcing a compositor resize flush
+                            CompositorController::setBounds(change.client, previousState.x, previousState.y, previousState.width, previousState.height);
+                        }
+                        if (change.hasScaleX || change.hasScaleY)
+                        {
+                            CompositorController::setScale(change.client, previousState.scaleX, previousState.scaleY);
+                        }
+                        if (change.hasOpacity)
+                        {
+                            CompositorController::setOpacity(change.client, previousState.opacity);
+                        }
+                        if (change.hasVisible)
+                        {
+                            CompositorController::setVisibility(change.client, previousState.visible);
+                        }
+                        if (change.hasHolePunch)
+                        {
+                            CompositorController::setHolePunch(change.client, previousState.holePunch);
+                        }
+                    }
+                    // zOrder lists the top most client first
+                    for (auto client = zOrder.rbegin(); client != zOrder.rend(); client++)
+                    {
+                        CompositorController::moveToFront(*client);
+                    }
+                    return false;
+                }
+                for (size_t i = 0; i < boundsFences.size(); i++)
+                {
+                    addBoundsFence(boundsFences[i]);
+                }
+                return true;
+            });
+
+            if (ret && fence > 0)
+            {
+                for (size_t i = 0; i < changes.size(); i++)
+                {
+                    if (changes[i].hasVisible)
+                    {
+                        setBrowserVisibility(changes[i].callsign, changes[i].visible);
+                    }
+                }
+                if (waitForFrame && !waitForRdkShellFrameFence(fence))
+                {
+                    std::cout << "layout not presented yet\n";
+                }
+            }
+            return ret;
+        }
+
         bool RDKShell::enableInactivityReporting(const bool enable)
         {
             lockRdkShellMutex();
             CompositorController::enableInactivityReporting(enable);
-            gRdkShellMutex.unlock();
+            unlockRdkShellMutex();
             return true;
         }
 
@@ -5636,7 +7784,7 @@ namespace WPEFramework {
             {
               std::cout << "RDKShell unable to set inactivity interval  " << std::endl;
             }
-            gRdkShellMutex.unlock();
+            unlockRdkShellMutex();
             return true;
         }
 
@@ -5652,7 +7800,7 @@ namespace WPEFramework {
             {
               std::cout << "RDKShell unable to reset inactivity time  " << std::endl;
             }
-            gRdkShellMutex.unlock();
+            unlockRdkShellMutex();
             return true;
         }
 
@@ -5687,6 +7835,7 @@ namespace WPEFramework {
             std::cout << "RDKShell onFocus event received for " << client << std::endl;
             JsonObject params;
             params["client"] = client;
+            setLastForegroundTime(client);
             notify(RDKSHELL_EVENT_ON_FOCUS, params);
         }
 
@@ -5695,14 +7844,18 @@ namespace WPEFramework {
             std::cout << "RDKShell onBlur event received for " << client << std::endl;
             JsonObject params;
             params["client"] = client;
+            if (!client.empty())
+            {
+                setLastForegroundTime(client);
+            }
             notify(RDKSHELL_EVENT_ON_BLUR, params);
         }
 
         bool RDKShell::systemMemory(uint32_t &freeKb, uint32_t & totalKb, uint32_t & usedSwapKb)
         {
-            lockRdkShellMutex();
+            lockRdkShellMutexForRead();
             bool ret = RdkShell::systemRam(freeKb, totalKb, usedSwapKb);
-            gRdkShellMutex.unlock();
+            unlockRdkShellMutex();
             return ret;
         }
 
@@ -5728,9 +7881,9 @@ namespace WPEFramework {
         bool RDKShell::getKeyRepeatsEnabled(bool& enable)
         {
             bool ret = false;
-            lockRdkShellMutex();
+            lockRdkShellMutexForRead();
             ret = CompositorController::getKeyRepeatsEnabled(enable);
-            gRdkShellMutex.unlock();
+            unlockRdkShellMutex();
             return ret;
         }
 
@@ -5739,52 +7892,46 @@ namespace WPEFramework {
             bool ret = false;
             lockRdkShellMutex();
             ret = CompositorController::enableKeyRepeats(enable);
-            gRdkShellMutex.unlock();
+            unlockRdkShellMutex();
             return ret;
         }
 
         bool RDKShell::setTopmost(const string& callsign, const bool topmost)
         {
-            bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::setTopmost(callsign, topmost);
-            gRdkShellMutex.unlock();
-            return ret;
+            return runRdkShellCommand([&]() {
+                return CompositorController::setTopmost(callsign, topmost);
+            });
         }
 
         bool RDKShell::getVirtualResolution(const std::string& client, uint32_t &virtualWidth, uint32_t &virtualHeight)
         {
             bool ret = false;
-            lockRdkShellMutex();
+            lockRdkShellMutexForRead();
             ret = CompositorController::getVirtualResolution(client, virtualWidth, virtualHeight);
-            gRdkShellMutex.unlock();
+            unlockRdkShellMutex();
             return ret;
         }
 
         bool RDKShell::setVirtualResolution(const std::string& client, const uint32_t virtualWidth, const uint32_t virtualHeight)
         {
-            bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::setVirtualResolution(client, virtualWidth, virtualHeight);
-            gRdkShellMutex.unlock();
-            return ret;
+            return runRdkShellCommand([&]() {
+                return CompositorController::setVirtualResolution(client, virtualWidth, virtualHeight);
+            });
         }
 
         bool RDKShell::enableVirtualDisplay(const std::string& client, const bool enable)
         {
-            bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::enableVirtualDisplay(client, enable);
-            gRdkShellMutex.unlock();
-            return ret;
+            return runRdkShellCommand([&]() {
+                return CompositorController::enableVirtualDisplay(client, enable);
+            });
         }
 
         bool RDKShell::getVirtualDisplayEnabled(const std::string& client, bool &enabled)
         {
             bool ret = false;
-            lockRdkShellMutex();
+            lockRdkShellMutexForRead();
             ret = CompositorController::getVirtualDisplayEnabled(client, enabled);
-            gRdkShellMutex.unlock();
+            unlockRdkShellMutex();
             return ret;
         }
 
@@ -5841,7 +7988,7 @@ namespace WPEFramework {
             {
                 ret = CompositorController::hideWatermark();
             }
-            gRdkShellMutex.unlock();
+            unlockRdkShellMutex();
             return ret;
         }
 
@@ -5851,7 +7998,7 @@ namespace WPEFramework {
             lockRdkShellMutex();
             fullScreenImagePath = path;
             receivedFullScreenImageRequest = true;
-            gRdkShellMutex.unlock();
+            unlockRdkShellMutex();
             return ret;
         }
 
@@ -5886,7 +8033,7 @@ namespace WPEFramework {
                 {  
                     std::string serviceCallsign = SYSTEM_SERVICE_CALLSIGN;
                     serviceCallsign.append(".2");
-                    gSystemServiceConnection = RDKShell::getThunderControllerClient(serviceCallsign);
+                    gSystemServiceConnection = RDKShell::createThunderControllerClient(serviceCallsign);
                 }
             }
 
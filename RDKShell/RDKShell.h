@@ -20,6 +20,7 @@
 #pragma once
 
 #include <mutex>
+#include <set>
 #include "Module.h"
 #include "utils.h"
 #include <rdkshell/rdkshellevents.h>
@@ -121,6 +122,15 @@ namespace WPEFramework {
             static const string RDKSHELL_METHOD_GET_LAST_WAKEUP_KEY;
             static const string RDKSHELL_METHOD_GET_SCREENSHOT;
             static const string RDKSHELL_METHOD_ENABLE_EASTER_EGGS;
+            static const string RDKSHELL_METHOD_APPLY_LAYOUT;
+            static const string RDKSHELL_METHOD_ACKNOWLEDGE_WILL_DESTROY;
+            static const string RDKSHELL_METHOD_GET_FRAME_STATS;
+            static const string RDKSHELL_METHOD_SET_FRAME_STATS_INTERVAL;
+            static const string RDKSHELL_METHOD_GET_LAUNCH_HISTORY;
+            static const string RDKSHELL_METHOD_SET_PREWARM_APPS;
+            static const string RDKSHELL_METHOD_GET_PREWARM_APPS;
+            static const string RDKSHELL_METHOD_CANCEL_GENERATE_KEY;
+            static const string RDKSHELL_METHOD_SET_EVICTION_POLICY;
 
             // events
             static const string RDKSHELL_EVENT_ON_USER_INACTIVITY;
@@ -145,6 +155,12 @@ namespace WPEFramework {
             static const string RDKSHELL_EVENT_ON_SCREENSHOT_COMPLETE;
             static const string RDKSHELL_EVENT_ON_FOCUS;
             static const string RDKSHELL_EVENT_ON_BLUR;
+            static const string RDKSHELL_EVENT_SIZE_CHANGE_COMPLETE;
+            static const string RDKSHELL_EVENT_ON_BOUNDS_APPLIED;
+            static const string RDKSHELL_EVENT_ON_FRAME_STATS;
+            static const string RDKSHELL_EVENT_ON_LAUNCH_TIMELINE;
+            static const string RDKSHELL_EVENT_ON_KEY_SEQUENCE_COMPLETE;
+            static const string RDKSHELL_EVENT_ON_APP_EVICTED;
 
             void notify(const std::string& event, const JsonObject& parameters);
             void pluginEventHandler(const JsonObject& parameters);
@@ -221,6 +237,15 @@ namespace WPEFramework {
             uint32_t getLastWakeupKeyWrapper(const JsonObject& parameters, JsonObject& response);
             uint32_t getScreenshotWrapper(const JsonObject& parameters, JsonObject& response);
             uint32_t enableEasterEggsWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t applyLayoutWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t acknowledgeWillDestroyWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getFrameStatsWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t setFrameStatsIntervalWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getLaunchHistoryWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t setPrewarmAppsWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getPrewarmAppsWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t cancelGenerateKeyWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t setEvictionPolicyWrapper(const JsonObject& parameters, JsonObject& response);
 
         private/*internal methods*/:
             RDKShell(const RDKShell&) = delete;
@@ -238,6 +263,9 @@ namespace WPEFramework {
             bool addAnyKeyListener(const string& client, const JsonArray& listeners);
             bool injectKey(const uint32_t& keyCode, const JsonArray& modifiers);
             bool generateKey(const string& client, const JsonArray& keyInputs);
+            bool scheduleKeySequence(const string& client, const JsonArray& keyInputs, uint32_t& sequenceId);
+            bool cancelKeySequence(const uint32_t sequenceId);
+            void runKeySequences();
             bool getScreenResolution(JsonObject& out);
             bool setScreenResolution(const unsigned int w, const unsigned int h);
             bool setMimeType(const string& client, const string& mimeType);
@@ -247,9 +275,10 @@ namespace WPEFramework {
             bool getClients(JsonArray& clients);
             bool getZOrder(JsonArray& clients);
             bool getBounds(const string& client, JsonObject& bounds);
-            bool setBounds(const string& client, const unsigned int x, const unsigned int y, const unsigned int w, const unsigned int h);
+            bool setBounds(const string& client, const unsigned int x, const unsigned int y, const unsigned int w, const unsigned int h, const bool waitForFrame = false);
             bool getVisibility(const string& client, bool& visibility);
             bool setVisibility(const string& client, const bool visible);
+            void setBrowserVisibility(const string& client, const bool visible);
             bool getOpacity(const string& client, unsigned int& opacity);
             bool setOpacity(const string& client, const unsigned int opacity);
             bool getScale(const string& client, double& scaleX, double& scaleY);
@@ -258,6 +287,7 @@ namespace WPEFramework {
             bool setHolePunch(const string& client, const bool holePunch);
             bool removeAnimation(const string& client);
             bool addAnimationList(const JsonArray& animations);
+            bool applyLayout(const JsonArray& layout, const bool waitForFrame);
             bool enableInactivityReporting(const bool enable);
             bool setInactivityInterval(const uint32_t interval);
             bool resetInactivityTime();
@@ -271,6 +301,13 @@ namespace WPEFramework {
             bool showWatermark(const bool enable);
             bool showFullScreenImage(std::string& path);
             void killAllApps(bool enableDestroyEvent=false);
+            void getRunningApps(std::vector<std::string>& callsigns);
+            uint32_t launchApp(const JsonObject& parameters, JsonObject& response, const bool prewarm);
+            bool destroyApp(const std::string& callsign, std::string& message);
+            void getAppStates(JsonArray& stateArray);
+            void prewarmApps();
+            void evictApps();
+            void destroyApps(const std::vector<std::string>& callsigns, const std::set<std::string>& willDestroyCallsigns);
             bool checkForBootupFactoryAppLaunch();
             bool enableKeyRepeats(const bool enable);
             bool getKeyRepeatsEnabled(bool& enable);
@@ -288,6 +325,7 @@ namespace WPEFramework {
             void removeFactoryModeEasterEggs();
 
             static std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> > getThunderControllerClient(std::string callsign="", std::string localidentifier="");
+            static std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> > createThunderControllerClient(std::string callsign="", std::string localidentifier="");
             static std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> > getPackagerPlugin();
             static std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> > getOCIContainerPlugin();
 
@@ -261,14 +261,14 @@ namespace WPEFramework {
                 SYSSRV_MINOR_VERSION);
 
         SystemServices* SystemServices::_instance = nullptr;
-        cSettings SystemServices::m_temp_settings(SYSTEM_SERVICE_TEMP_FILE);
+        cSettings SystemServices::m_temp_settings(SYSTEM_SERVICE_TEMP_FILE, SETTINGS_WRITE_BEHIND_MS);
 
         /**
          * Register SystemService module as wpeframework plugin
          */
         SystemServices::SystemServices()
             : AbstractPlugin(2)
-              , m_cacheService(SYSTEM_SERVICE_SETTINGS_FILE)
+              , m_cacheService(SYSTEM_SERVICE_SETTINGS_FILE, SETTINGS_WRITE_BEHIND_MS)
         {
             SystemServices::_instance = this;
 
@@ -431,6 +431,8 @@ namespace WPEFramework {
 #if defined(USE_IARMBUS) || defined(USE_IARM_BUS)
             DeinitializeIARM();
 #endif /* defined(USE_IARMBUS) || defined(USE_IARM_BUS) */
+            m_temp_settings.flush();
+            m_cacheService.flush();
             SystemServices::_instance = nullptr;
             m_shellService->Release();
             m_shellService = nullptr;
@@ -514,6 +516,9 @@ namespace WPEFramework {
             LOGINFO("requestSystemReboot: custom reason: %s, other reason: %s\n", rebootParam.reboot_reason_custom,
                 rebootParam.reboot_reason_other);
 
+            m_temp_settings.flush();
+            m_cacheService.flush();
+
             IARM_Result_t iarmcallstatus = IARM_Bus_Call(IARM_BUS_PWRMGR_NAME,
                     IARM_BUS_PWRMGR_API_Reboot, &rebootParam, sizeof(rebootParam));
             if(IARM_RESULT_SUCCESS != iarmcallstatus) {
@@ -52,6 +52,25 @@ namespace WPEFramework {
                 response["quirks"] = array;
                 returnResponse(true);
             }
+
+            uint32_t getPluginLogLevel(const JsonObject& parameters, JsonObject& response)
+            {
+                response["level"] = Utils::AsyncLog::levelName(Utils::AsyncLog::level().load());
+                returnResponse(true);
+            }
+
+            uint32_t setPluginLogLevel(const JsonObject& parameters, JsonObject& response)
+            {
+                returnIfStringParamNotFound(parameters, "level");
+                int level = Utils::AsyncLog::levelFromName(parameters["level"].String().c_str());
+                if (level < 0)
+                {
+                    LOGERR("Unknown log level '%s'", parameters["level"].String().c_str());
+                    returnResponse(false);
+                }
+                Utils::AsyncLog::level().store(level);
+                returnResponse(true);
+            }
             //End methods
 
         protected:
@@ -104,6 +123,8 @@ namespace WPEFramework {
                 m_versionHandlers[1] = GetHandler(1);
 
                 registerMethod("getQuirks", &AbstractPlugin::getQuirks, this);
+                registerMethod("getPluginLogLevel", &AbstractPlugin::getPluginLogLevel, this);
+                registerMethod("setPluginLogLevel", &AbstractPlugin::setPluginLogLevel, this);
 
                 Utils::Telemetry::init();
             }
@@ -121,6 +142,8 @@ namespace WPEFramework {
                 }
 
                 registerMethod("getQuirks", &AbstractPlugin::getQuirks, this);
+                registerMethod("getPluginLogLevel", &AbstractPlugin::getPluginLogLevel, this);
+                registerMethod("setPluginLogLevel", &AbstractPlugin::setPluginLogLevel, this);
 
                 Utils::Telemetry::init();
             }
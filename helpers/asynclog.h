@@ -0,0 +1,605 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2019 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <cerrno>
+#include <vector>
+#include <strings.h>
+#include <unistd.h>
+#include <signal.h>
+#include <syscall.h>
+#include <dlfcn.h>
+
+// number of pending log lines per plugin library and the maximum length of a queued line, longer lines are
+// written synchronously on the calling thread
+#ifndef ASYNC_LOG_SLOTS
+#define ASYNC_LOG_SLOTS 128
+#endif
+
+#ifndef ASYNC_LOG_SLOT_SIZE
+#define ASYNC_LOG_SLOT_SIZE 512
+#endif
+
+#define ASYNC_LOG_BATCH_SIZE 8192
+#define ASYNC_LOG_IDLE_WAIT_IN_MS 100
+#define ASYNC_LOG_CRASH_REGISTRY_SIZE 64
+
+// crash handler and registry of the queues flushed by it, exported so that every plugin library can find them
+// in the library that installed the handler (see Utils::AsyncLog::Backend)
+extern "C" inline void* rdkservices_async_log_crash_registry() __attribute__ ((visibility("protected"), used));
+extern "C" inline void rdkservices_async_log_on_crash(int signal) __attribute__ ((visibility("protected"), used));
+
+namespace Utils
+{
+namespace AsyncLog
+{
+    enum Level { LEVEL_ERROR = 0, LEVEL_WARN, LEVEL_INFO, LEVEL_DEBUG };
+
+    inline const char* levelName(int level)
+    {
+        static const char* names[] = { "error", "warn", "info", "debug" };
+        return (level >= LEVEL_ERROR && level <= LEVEL_DEBUG) ? names[level] : "unknown";
+    }
+
+    // returns -1 for an unknown name
+    inline int levelFromName(const char* name)
+    {
+        for (int level = LEVEL_ERROR; level <= LEVEL_DEBUG; level++)
+        {
+            if (strcasecmp(name, levelName(level)) == 0)
+            {
+                return level;
+            }
+        }
+        return -1;
+    }
+
+    // log level of the plugin library, starts at RDKSERVICES_LOG_LEVEL or debug so that nothing is filtered by default
+    inline std::atomic<int>& level()
+    {
+        static std::atomic<int> logLevel([]() {
+            const char* value = getenv("RDKSERVICES_LOG_LEVEL");
+            int initialLevel = (nullptr != value) ? levelFromName(value) : -1;
+            return (initialLevel >= 0) ? initialLevel : (int)LEVEL_DEBUG;
+        }());
+        return logLevel;
+    }
+
+    // checked by the log macros before anything is formatted
+    inline bool isEnabled(int messageLevel)
+    {
+        return messageLevel <= level().load(std::memory_order_relaxed);
+    }
+
+    // thread id of the caller, looked up once per thread instead of once per log line
+    inline int threadId()
+    {
+        static thread_local int tid = (int)syscall(SYS_gettid);
+        return tid;
+    }
+
+    // only uses async signal safe calls
+    inline void writeAll(const char* buffer, size_t length)
+    {
+        size_t written = 0;
+        while (written < length)
+        {
+            ssize_t result = ::write(STDERR_FILENO, buffer + written, length - written);
+            if (result < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (result <= 0)
+            {
+                break;
+            }
+            written += result;
+        }
+    }
+
+    // a slot per queue, the flush function is the one of the library the queue belongs to
+    struct CrashRegistry
+    {
+        std::atomic<void*> queues[ASYNC_LOG_CRASH_REGISTRY_SIZE];
+        std::atomic<void (*)(void*)> flushes[ASYNC_LOG_CRASH_REGISTRY_SIZE];
+    };
+
+    /**
+     * Bounded lock-free multi producer queue of formatted log lines (Vyukov style, a sequence number per slot)
+     * drained to stderr by one writer thread in batches. Producers never block: when the queue is full the
+     * line is counted as dropped and the count is reported with the next batch. A line that does not fit a
+     * slot is written on the calling thread after the lines queued before it.
+     *
+     * Every plugin library that includes utils.h gets its own backend. It is created with the first log line
+     * and flushed synchronously when the library is unloaded and when the process exits.
+     *
+     * On SIGSEGV/SIGABRT/SIGBUS/SIGFPE/SIGILL the queues of all plugin libraries are written by one crash
+     * handler. The first library that finds no handler installs it and is pinned (RTLD_NODELETE) so that the
+     * handler stays mapped, the others find its registry with dladdr/dlsym and add their queue to it. Limits:
+     * nothing is flushed when another handler was installed first, the handler stops at a line that is still
+     * being formatted, and lines of the batch the writer thread is writing at that moment may appear twice.
+     */
+    class Backend
+    {
+    public:
+        enum State { NOT_STARTED = 0, RUNNING, STOPPED };
+
+        static std::atomic<int>& state()
+        {
+            static std::atomic<int> backendState(NOT_STARTED);
+            return backendState;
+        }
+
+        static Backend& instance()
+        {
+            static Backend backend;
+            return backend;
+        }
+
+        void write(const char* level, const char* file, int line, const char* function, const char* format, va_list parameters)
+        {
+            size_t position = mEnqueuePosition.load(std::memory_order_relaxed);
+            Slot* slot = nullptr;
+            for (;;)
+            {
+                slot = &mSlots[position % ASYNC_LOG_SLOTS];
+                size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+                if (difference == 0)
+                {
+                    if (mEnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (difference < 0)
+                {
+                    mDropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                else
+                {
+                    position = mEnqueuePosition.load(std::memory_order_relaxed);
+                }
+            }
+
+            va_list copy;
+            va_copy(copy, parameters);
+            size_t length = formatLine(slot->data, ASYNC_LOG_SLOT_SIZE, level, file, line, function, format, parameters);
+            const bool queued = (length < ASYNC_LOG_SLOT_SIZE);
+            slot->length = queued ? length : 0;
+            slot->sequence.store(position + 1, std::memory_order_release);
+
+            if (queued)
+            {
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (mWriterSleeping.load(std::memory_order_relaxed))
+                {
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    mWakeup = true;
+                    mCondition.notify_one();
+                }
+            }
+            else
+            {
+                flush();
+                writeLine(level, file, line, function, format, copy);
+            }
+            va_end(copy);
+        }
+
+        // writes every pending line on the calling thread
+        void flush()
+        {
+            std::lock_guard<std::mutex> lock(mDrainMutex);
+            char batch[ASYNC_LOG_BATCH_SIZE];
+            while (drain(batch));
+        }
+
+        // returns the length of the whole line including the newline, the line is only complete in buffer when
+        // that is less than size
+        static size_t formatLine(char* buffer, size_t size, const char* level, const char* file, int line, const char* function, const char* format, va_list parameters)
+        {
+            int headerLength = snprintf(buffer, size, "[%d] %s [%s:%d] %s: ", threadId(), level, file, line, function);
+            size_t length = (headerLength > 0) ? (size_t)headerLength : 0;
+            int messageLength = (length < size) ? vsnprintf(buffer + length, size - length, format, parameters) : vsnprintf(nullptr, 0, format, parameters);
+            if (messageLength > 0)
+            {
+                length += messageLength;
+            }
+            if (length + 1 < size)
+            {
+                buffer[length] = '\n';
+                buffer[length + 1] = '\0';
+            }
+            return length + 1;
+        }
+
+        // formats and writes one line of any length on the calling thread
+        static void writeLine(const char* level, const char* file, int line, const char* function, const char* format, va_list parameters)
+        {
+            va_list copy;
+            va_copy(copy, parameters);
+            char buffer[ASYNC_LOG_SLOT_SIZE];
+            size_t length = formatLine(buffer, sizeof(buffer), level, file, line, function, format, parameters);
+            if (length < sizeof(buffer))
+            {
+                writeAll(buffer, length);
+            }
+            else
+            {
+                std::vector<char> longLine(length + 1);
+                formatLine(longLine.data(), longLine.size(), level, file, line, function, format, copy);
+                writeAll(longLine.data(), length);
+            }
+            va_end(copy);
+        }
+
+        // called by the crash handler for every registered queue. writes the pending lines without taking them
+        // off the queue, so only async signal safe calls and no locks
+        static void flushOnCrash(void* queue)
+        {
+            Backend* backend = (Backend*)queue;
+            char batch[ASYNC_LOG_BATCH_SIZE];
+            size_t batchLength = backend->formatDropped(batch);
+            size_t position = backend->mDequeuePosition.load(std::memory_order_acquire);
+            for (size_t count = 0; count < ASYNC_LOG_SLOTS; count++)
+            {
+                Slot* slot = &backend->mSlots[(position + count) % ASYNC_LOG_SLOTS];
+                if (slot->sequence.load(std::memory_order_acquire) != position + count + 1)
+                {
+                    break;
+                }
+                if (batchLength + slot->length > ASYNC_LOG_BATCH_SIZE)
+                {
+                    writeAll(batch, batchLength);
+                    batchLength = 0;
+                }
+                memcpy(batch + batchLength, slot->data, slot->length);
+                batchLength += slot->length;
+            }
+            writeAll(batch, batchLength);
+        }
+
+    private:
+        struct Slot
+        {
+            std::atomic<size_t> sequence;
+            size_t length;
+            char data[ASYNC_LOG_SLOT_SIZE];
+        };
+
+        Backend()
+            : mEnqueuePosition(0)
+            , mDequeuePosition(0)
+            , mDropped(0)
+            , mWriterSleeping(false)
+            , mWakeup(false)
+            , mRunning(true)
+            , mCrashRegistry(nullptr)
+            , mCrashSlot(0)
+        {
+            for (size_t i = 0; i < ASYNC_LOG_SLOTS; i++)
+            {
+                mSlots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            registerForCrash();
+            state().store(RUNNING);
+            mWriter = std::thread([this]() { run(); });
+        }
+
+        ~Backend()
+        {
+            unregisterForCrash();
+            state().store(STOPPED);
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mRunning = false;
+                mCondition.notify_one();
+            }
+            if (mWriter.joinable())
+            {
+                mWriter.join();
+            }
+            flush();
+        }
+
+        Backend(const Backend&) = delete;
+        Backend& operator=(const Backend&) = delete;
+
+        bool empty() const
+        {
+            size_t position = mDequeuePosition.load(std::memory_order_relaxed);
+            return mSlots[position % ASYNC_LOG_SLOTS].sequence.load(std::memory_order_acquire) != position + 1;
+        }
+
+        // "WARN [asynclog.h] dropped <count> log lines", built without snprintf so that the crash handler can use it
+        size_t formatDropped(char* buffer)
+        {
+            static const char prefix[] = "WARN [asynclog.h] dropped ";
+            static const char suffix[] = " log lines\n";
+            uint32_t dropped = mDropped.exchange(0, std::memory_order_relaxed);
+            if (dropped == 0)
+            {
+                return 0;
+            }
+            char digits[10];
+            size_t digitCount = 0;
+            do
+            {
+                digits[digitCount++] = '0' + (dropped % 10);
+                dropped /= 10;
+            } while (dropped > 0);
+            size_t length = sizeof(prefix) - 1;
+            memcpy(buffer, prefix, length);
+            while (digitCount > 0)
+            {
+                buffer[length++] = digits[--digitCount];
+            }
+            memcpy(buffer + length, suffix, sizeof(suffix) - 1);
+            return length + sizeof(suffix) - 1;
+        }
+
+        // writes as many pending lines as fit into one batch, returns false when nothing was pending. called with
+        // mDrainMutex held. the slots are only released once the batch is written so that the crash handler can
+        // still find lines that are being written
+        bool drain(char* batch)
+        {
+            size_t batchLength = formatDropped(batch);
+            size_t position = mDequeuePosition.load(std::memory_order_relaxed);
+            size_t count = 0;
+            while (count < ASYNC_LOG_SLOTS && batchLength + ASYNC_LOG_SLOT_SIZE <= ASYNC_LOG_BATCH_SIZE)
+            {
+                Slot* slot = &mSlots[(position + count) % ASYNC_LOG_SLOTS];
+                if (slot->sequence.load(std::memory_order_acquire) != position + count + 1)
+                {
+                    break;
+                }
+                memcpy(batch + batchLength, slot->data, slot->length);
+                batchLength += slot->length;
+                count++;
+            }
+            writeAll(batch, batchLength);
+            for (size_t i = 0; i < count; i++)
+            {
+                mSlots[(position + i) % ASYNC_LOG_SLOTS].sequence.store(position + i + ASYNC_LOG_SLOTS, std::memory_order_release);
+            }
+            mDequeuePosition.store(position + count, std::memory_order_relaxed);
+            return (batchLength > 0 || count > 0);
+        }
+
+        void run()
+        {
+            char batch[ASYNC_LOG_BATCH_SIZE];
+            for (;;)
+            {
+                bool drained = false;
+                {
+                    std::lock_guard<std::mutex> lock(mDrainMutex);
+                    drained = drain(batch);
+                }
+                if (drained)
+                {
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(mMutex);
+                if (!mRunning)
+                {
+                    break;
+                }
+                mWriterSleeping.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (empty() && mDropped.load(std::memory_order_relaxed) == 0)
+                {
+                    mCondition.wait_for(lock, std::chrono::milliseconds(ASYNC_LOG_IDLE_WAIT_IN_MS), [this]() { return mWakeup || !mRunning; });
+                }
+                mWakeup = false;
+                mWriterSleeping.store(false, std::memory_order_relaxed);
+            }
+        }
+
+        static const int* crashSignals()
+        {
+            static const int signals[] = { SIGSEGV, SIGABRT, SIGBUS, SIGFPE, SIGILL, 0 };
+            return signals;
+        }
+
+        // keeps the library that installs the crash handler loaded until the process exits
+        static void pinLibrary()
+        {
+            Dl_info info;
+            if (dladdr((void*)&rdkservices_async_log_on_crash, &info) != 0 && nullptr != info.dli_fname)
+            {
+                void* library = dlopen(info.dli_fname, RTLD_LAZY | RTLD_NOLOAD | RTLD_NODELETE);
+                if (nullptr != library)
+                {
+                    dlclose(library);
+                }
+            }
+        }
+
+        static void installCrashHandlers()
+        {
+            for (const int* signal = crashSignals(); *signal != 0; signal++)
+            {
+                struct sigaction current;
+                if (sigaction(*signal, nullptr, &current) == 0 && !(current.sa_flags & SA_SIGINFO) && current.sa_handler == SIG_DFL)
+                {
+                    struct sigaction action;
+                    memset(&action, 0, sizeof(action));
+                    action.sa_handler = rdkservices_async_log_on_crash;
+                    sigemptyset(&action.sa_mask);
+                    action.sa_flags = SA_RESETHAND;
+                    sigaction(*signal, &action, nullptr);
+                }
+            }
+        }
+
+        // returns the registry of the library the handler belongs to, nullptr when it is not the async log handler
+        static CrashRegistry* findCrashRegistry(void (*handler)(int))
+        {
+            Dl_info info;
+            if (dladdr((void*)handler, &info) == 0 || nullptr == info.dli_fname)
+            {
+                return nullptr;
+            }
+            void* library = dlopen(info.dli_fname, RTLD_LAZY | RTLD_NOLOAD);
+            if (nullptr == library)
+            {
+                return nullptr;
+            }
+            CrashRegistry* registry = nullptr;
+            void* onCrash = dlsym(library, "rdkservices_async_log_on_crash");
+            void* getRegistry = dlsym(library, "rdkservices_async_log_crash_registry");
+            if (onCrash == (void*)handler && nullptr != getRegistry)
+            {
+                registry = (CrashRegistry*)((void* (*)())getRegistry)();
+            }
+            dlclose(library);
+            return registry;
+        }
+
+        void registerForCrash()
+        {
+            CrashRegistry* registry = nullptr;
+            // the handler is read back after installing it, another library may have installed its own meanwhile
+            for (int attempt = 0; attempt < 2 && nullptr == registry; attempt++)
+            {
+                struct sigaction current;
+                if (sigaction(SIGSEGV, nullptr, &current) != 0 || (current.sa_flags & SA_SIGINFO) || current.sa_handler == SIG_IGN)
+                {
+                    break;
+                }
+                if (current.sa_handler == SIG_DFL)
+                {
+                    pinLibrary();
+                    installCrashHandlers();
+                    continue;
+                }
+                registry = findCrashRegistry(current.sa_handler);
+                if (nullptr == registry)
+                {
+                    break;
+                }
+            }
+            if (nullptr == registry)
+            {
+                return;
+            }
+            for (size_t i = 0; i < ASYNC_LOG_CRASH_REGISTRY_SIZE; i++)
+            {
+                void* expected = nullptr;
+                if (registry->queues[i].compare_exchange_strong(expected, this))
+                {
+                    registry->flushes[i].store(&Backend::flushOnCrash, std::memory_order_release);
+                    mCrashRegistry = registry;
+                    mCrashSlot = i;
+                    return;
+                }
+            }
+        }
+
+        // must happen before the library is unloaded, the handler would call into it otherwise
+        void unregisterForCrash()
+        {
+            if (nullptr != mCrashRegistry)
+            {
+                mCrashRegistry->flushes[mCrashSlot].store(nullptr, std::memory_order_release);
+                mCrashRegistry->queues[mCrashSlot].store(nullptr, std::memory_order_release);
+                mCrashRegistry = nullptr;
+            }
+        }
+
+        Slot mSlots[ASYNC_LOG_SLOTS];
+        std::atomic<size_t> mEnqueuePosition;
+        std::atomic<size_t> mDequeuePosition;
+        std::atomic<uint32_t> mDropped;
+        std::atomic<bool> mWriterSleeping;
+        std::mutex mMutex;
+        std::mutex mDrainMutex;
+        std::condition_variable mCondition;
+        bool mWakeup;
+        bool mRunning;
+        CrashRegistry* mCrashRegistry;
+        size_t mCrashSlot;
+        std::thread mWriter;
+    };
+
+    inline void write(const char* level, const char* file, int line, const char* function, const char* format, ...) __attribute__ ((format (printf, 5, 6)));
+
+    inline void write(const char* level, const char* file, int line, const char* function, const char* format, ...)
+    {
+        va_list parameters;
+        va_start(parameters, format);
+        if (Backend::state().load(std::memory_order_acquire) != Backend::STOPPED)
+        {
+            Backend::instance().write(level, file, line, function, format, parameters);
+        }
+        else
+        {
+            // the backend is gone during static destruction, write synchronously
+            Backend::writeLine(level, file, line, function, format, parameters);
+        }
+        va_end(parameters);
+    }
+
+    // writes all pending lines before returning, e.g. before an intentional abort
+    inline void flush()
+    {
+        if (Backend::state().load(std::memory_order_acquire) == Backend::RUNNING)
+        {
+            Backend::instance().flush();
+        }
+    }
+} // namespace AsyncLog
+} // namespace Utils
+
+extern "C" inline void* rdkservices_async_log_crash_registry()
+{
+    static Utils::AsyncLog::CrashRegistry registry;
+    return &registry;
+}
+
+// writes the queues of all registered plugin libraries and lets the default action terminate the process
+extern "C" inline void rdkservices_async_log_on_crash(int signal)
+{
+    Utils::AsyncLog::CrashRegistry* registry = (Utils::AsyncLog::CrashRegistry*)rdkservices_async_log_crash_registry();
+    for (size_t i = 0; i < ASYNC_LOG_CRASH_REGISTRY_SIZE; i++)
+    {
+        void* queue = registry->queues[i].load(std::memory_order_acquire);
+        void (*flush)(void*) = registry->flushes[i].load(std::memory_order_acquire);
+        if (nullptr != queue && nullptr != flush)
+        {
+            flush(queue);
+        }
+    }
+    ::signal(signal, SIG_DFL);
+    raise(signal);
+}
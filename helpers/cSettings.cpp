@@ -18,8 +18,13 @@
 **/
 
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include "cSettings.h"
 #include "SystemServicesHelper.h"
 
@@ -27,7 +32,10 @@
  * @brief    : Constructor.
  * @return  : nil.
  */
-cSettings::cSettings(std::string file)
+cSettings::cSettings(std::string file, uint32_t writeBehindMs)
+    : writeBehindMs(writeBehindMs)
+    , dirty(false)
+    , flusherRunning(false)
 {
     filename = file;
     if (!readFromFile()) {
@@ -37,7 +45,7 @@ cSettings::cSettings(std::string file)
         if (!fs.is_open()) {
             std::cout << "Error:[ctor cSettings] unable to open configuration file." << std::endl;
         } else {
-            fs << flush;
+            fs << std::flush;
             fs.close();
         }
     }
@@ -49,7 +57,77 @@ cSettings::cSettings(std::string file)
  */
 cSettings::~cSettings()
 {
-    ;
+    {
+        std::lock_guard<std::recursive_mutex> lock(dataMutex);
+        flusherRunning = false;
+        flusherCondition.notify_one();
+    }
+    if (flusher.joinable()) {
+        flusher.join();
+    }
+    flush();
+}
+
+/***
+ * @brief    : Write pending updates now.
+ * @return  : <bool> False if the file couldn't be written.
+ */
+bool cSettings::flush()
+{
+    std::lock_guard<std::recursive_mutex> lock(dataMutex);
+    if (!dirty) {
+        return true;
+    }
+    return writeToFile();
+}
+
+/***
+ * @brief    : Write the file now or, in write-behind mode, schedule it.
+ * @return  : <bool> False if the file couldn't be written.
+ */
+bool cSettings::scheduleWrite()
+{
+    std::lock_guard<std::recursive_mutex> lock(dataMutex);
+    if (0 == writeBehindMs) {
+        return writeToFile();
+    }
+    if (!dirty) {
+        dirty = true;
+        flushDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(writeBehindMs);
+    }
+    if (!flusherRunning) {
+        if (flusher.joinable()) {
+            flusher.join();
+        }
+        flusherRunning = true;
+        flusher = std::thread(&cSettings::runFlusher, this);
+    }
+    flusherCondition.notify_one();
+    return true;
+}
+
+/***
+ * @brief    : Write-behind thread, writes the file once the oldest pending update is writeBehindMs old.
+ * @return  : nil.
+ */
+void cSettings::runFlusher()
+{
+    std::unique_lock<std::recursive_mutex> lock(dataMutex);
+    uint32_t retryMs = writeBehindMs;
+    while (flusherRunning) {
+        if (!dirty) {
+            flusherCondition.wait(lock);
+        } else if (std::chrono::steady_clock::now() < flushDeadline) {
+            flusherCondition.wait_until(lock, flushDeadline);
+        } else if (writeToFile()) {
+            retryMs = writeBehindMs;
+        } else {
+            /* the updates stay pending (flush() reports the failure), retry with a growing delay */
+            std::cout << "Error:[cSettings] unable to write " << filename << ", retrying in " << retryMs << "ms" << std::endl;
+            flushDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(retryMs);
+            retryMs = std::min(retryMs * 2, (uint32_t)SETTINGS_WRITE_RETRY_MAX_MS);
+        }
+    }
 }
 
 /***
@@ -58,6 +136,7 @@ cSettings::~cSettings()
  */
 bool cSettings::readFromFile()
 {
+    std::lock_guard<std::recursive_mutex> lock(dataMutex);
     bool retStatus = false;
     std::string content;
     if (!Utils::fileExists(filename.c_str())) {
@@ -85,25 +164,48 @@ bool cSettings::readFromFile()
  */
 bool cSettings::writeToFile()
 {
+    std::lock_guard<std::recursive_mutex> lock(dataMutex);
     bool status = false;
 
     if (Utils::fileExists(filename.c_str())) {
-        ofstream ofile;
-        ofile.open(filename.c_str(),ios::out);
-        if (ofile) {
-            JsonObject::Iterator iterator = data.Variants();
-            while (iterator.Next()) {
-                if (!data[iterator.Label()].String().empty()) {
-                    ofile << iterator.Label() << "=" << data[iterator.Label()].String() << endl;
-                } else {
-                    continue;
+        std::ostringstream content;
+        JsonObject::Iterator iterator = data.Variants();
+        while (iterator.Next()) {
+            if (!data[iterator.Label()].String().empty()) {
+                content << iterator.Label() << "=" << data[iterator.Label()].String() << endl;
+            } else {
+                continue;
+            }
+        }
+
+        /* Write a temporary file and rename it over the old one, so that a power loss leaves either file intact. */
+        std::string tmpFilename = filename + ".tmp";
+        std::string buffer = content.str();
+        int fd = open(tmpFilename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd >= 0) {
+            size_t written = 0;
+            while (written < buffer.size()) {
+                ssize_t result = write(fd, buffer.data() + written, buffer.size() - written);
+                if (result <= 0) {
+                    break;
                 }
+                written += result;
+            }
+            status = (written == buffer.size()) && (0 == fsync(fd));
+            close(fd);
+            if (status && (0 != rename(tmpFilename.c_str(), filename.c_str()))) {
+                status = false;
+            }
+            if (!status) {
+                std::cout << "Error:[cSettings] unable to replace " << filename << std::endl;
+                unlink(tmpFilename.c_str());
             }
-            status = true;
-            ofile.close();
         } else {
             status = false;
         }
+        if (status) {
+            dirty = false;
+        }
     }
     return status;
 }
@@ -115,6 +217,7 @@ bool cSettings::writeToFile()
  */
 JsonValue cSettings::getValue(std::string key)
 {
+    std::lock_guard<std::recursive_mutex> lock(dataMutex);
     return data.Get(key.c_str());
 }
 
@@ -126,8 +229,9 @@ JsonValue cSettings::getValue(std::string key)
  */
 bool cSettings::setValue(std::string key,std::string value)
 {
+    std::lock_guard<std::recursive_mutex> lock(dataMutex);
     data[key.c_str()] = value;
-    return writeToFile();
+    return scheduleWrite();
 }
 
 /***
@@ -138,8 +242,9 @@ bool cSettings::setValue(std::string key,std::string value)
  */
 bool cSettings::setValue(std::string key,int value)
 {
+    std::lock_guard<std::recursive_mutex> lock(dataMutex);
     data[key.c_str()] = value;
-    return writeToFile();
+    return scheduleWrite();
 }
 
 /***
@@ -150,8 +255,9 @@ bool cSettings::setValue(std::string key,int value)
  */
 bool cSettings::setValue(std::string key,bool value)
 {
+    std::lock_guard<std::recursive_mutex> lock(dataMutex);
     data[key.c_str()] = value;
-    return writeToFile();
+    return scheduleWrite();
 }
 
 /***
@@ -161,6 +267,7 @@ bool cSettings::setValue(std::string key,bool value)
  */
 bool cSettings::contains(std::string key)
 {
+    std::lock_guard<std::recursive_mutex> lock(dataMutex);
     bool resp = false;
     if (data.HasLabel(key.c_str())) {
         if (data[key.c_str()].String().empty()) {
@@ -181,6 +288,7 @@ bool cSettings::contains(std::string key)
  */
 bool cSettings::remove(std::string key)
 {
+    std::lock_guard<std::recursive_mutex> lock(dataMutex);
     bool status = false;
     /*
      * Noticed that there is an error with the Remove function.
@@ -190,7 +298,7 @@ bool cSettings::remove(std::string key)
     data[key.c_str()] = "";
     data.Remove(key.c_str());
     if (!contains(key)) {
-        if (writeToFile()) {
+        if (scheduleWrite()) {
             status = true;
         } else {
             status = false;
@@ -19,26 +19,55 @@
 
 #include <string>
 #include <stdlib.h>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
 #include <plugins/plugins.h>
 
 using namespace std;
 
+/* coalescing window used by the plugins that update several keys in a row */
+#define SETTINGS_WRITE_BEHIND_MS 500
+/* longest delay between two attempts to write a file that failed to be written */
+#define SETTINGS_WRITE_RETRY_MAX_MS 30000
+
 class cSettings {
     std::string filename;
     JsonObject data;
+    std::recursive_mutex dataMutex;
+    /* write-behind state, see cSettings(file, writeBehindMs) */
+    uint32_t writeBehindMs;
+    bool dirty;
+    bool flusherRunning;
+    std::chrono::steady_clock::time_point flushDeadline;
+    std::condition_variable_any flusherCondition;
+    std::thread flusher;
+
+    bool scheduleWrite();
+    void runFlusher();
     public:
     /***
      * @brief    : Constructor.
+     * @param1[in]   : <string> settings file
+     * @param2[in]   : <uint32_t> 0 writes the file on every update, otherwise updates are
+     *                 coalesced and written at most writeBehindMs after the first one
      * @return   : nil.
      */
-    cSettings(std::string file);
+    cSettings(std::string file, uint32_t writeBehindMs = 0);
 
     /***
-     * @brief    : Destructor.
+     * @brief    : Destructor, writes pending updates.
      * @return   : nil.
      */
     ~cSettings();
 
+    /***
+     * @brief    : Write pending updates now.
+     * @return   : <bool> False if the file couldn't be written.
+     */
+    bool flush();
+
     /***
      * @brief        : Get value of given key.
      * @param1[in]   : <string> key
@@ -25,8 +25,11 @@
  */
 cTimer::cTimer()
 {
-    clear = false;
     interval = 0;
+    callBack_function = NULL;
+    timerId = 0;
+    // construct the wheel first so that it outlives static timers
+    Utils::TimerWheel::instance();
 }
 
 /***
@@ -35,38 +38,33 @@ cTimer::cTimer()
  */
 cTimer::~cTimer()
 {
-    this->clear = true;
+    stop();
 }
 
 /***
- * @brief : start timer thread.
- * @return   : <bool> False if timer thread couldn't be started.
+ * @brief : start periodic timer on the shared timer wheel.
+ * @return   : <bool> False if no interval or function was set.
  */
 bool cTimer::start()
 {
-    if (interval <= 0 && callBack_function == NULL) {
+    if (interval <= 0 || callBack_function == NULL) {
         return false;
     }
-    this->clear = false;
-    std::thread timerThread([=]() {
-            while (true) {
-            if (this->clear) return;
-            std::this_thread::sleep_for(std::chrono::milliseconds(interval));
-            if (this->clear) return;
-            this->callBack_function();
-            }
-            });
-    timerThread.detach();
-    return true;
+    stop();
+    timerId = Utils::TimerWheel::instance().schedule(interval, callBack_function, interval);
+    return timerId != 0;
 }
 
 /***
- * @brief : stop timer thread.
+ * @brief : stop timer. Waits for a callback that is running on the timer thread.
  * @return   : nil
  */
 void cTimer::stop()
 {
-    this->clear = true;
+    if (timerId != 0) {
+        Utils::TimerWheel::instance().cancel(timerId);
+        timerId = 0;
+    }
 }
 
 /***
@@ -20,13 +20,15 @@
 #include <thread>
 #include <chrono>
 
+#include "timerwheel.h"
+
 using namespace std;
 
 class cTimer{
     private:
-        bool clear;
         int interval;
         void (*callBack_function)();
+        Utils::TimerWheel::TimerId timerId;
     public:
         /***
          * @brief    : Constructor.
@@ -41,13 +43,13 @@ class cTimer{
         ~cTimer();
 
         /***
-         * @brief    : start timer thread.
-         * @return   : <bool> False if timer thread couldn't be started.
+         * @brief    : start periodic timer on the shared timer wheel.
+         * @return   : <bool> False if no interval or function was set.
          */
         bool start();
 
         /***
-         * @brief   : stop timer thread.
+         * @brief   : stop timer.
          * @return   : nil
          */
         void stop();
@@ -78,8 +78,6 @@ namespace WPEFramework
         static std::vector<std::string> m_lights;
         static device::List <device::FrontPanelIndicator> fpIndicators;
 
-        static Core::TimerType<BlinkInfo> blinkTimer(64 * 1024, "BlinkTimer");
-
         namespace
         {
 
@@ -114,7 +112,7 @@ namespace WPEFramework
         }
 
         CFrontPanel::CFrontPanel()
-        : m_blinkTimer(this)
+        : m_blinkTimer(0)
         , m_isBlinking(false)
         , mFrontPanelHelper(new FrontPanelHelper())
         {
@@ -636,14 +634,18 @@ namespace WPEFramework
                 FrontPanelBlinkInfo blinkInfo = m_blinkList.at(0);
                 setBlinkLed(blinkInfo);
                 if (m_isBlinking)
-                    blinkTimer.Schedule(Core::Time::Now().Add(blinkInfo.durationInMs), m_blinkTimer);
+                    m_blinkTimer = Utils::TimerWheel::instance().schedule(blinkInfo.durationInMs, [this]() { onBlinkTimer(); });
             }
         }
 
         void CFrontPanel::stopBlinkTimer()
         {
             m_isBlinking = false;
-            blinkTimer.Revoke(m_blinkTimer);
+            if (m_blinkTimer != 0)
+            {
+                Utils::TimerWheel::instance().cancel(m_blinkTimer);
+                m_blinkTimer = 0;
+            }
         }
 
         void CFrontPanel::setBlinkLed(FrontPanelBlinkInfo blinkInfo)
@@ -697,7 +699,7 @@ namespace WPEFramework
                 FrontPanelBlinkInfo blinkInfo = m_blinkList.at(m_currentBlinkListIndex);
                 setBlinkLed(blinkInfo);
                 if (m_isBlinking)
-                    blinkTimer.Schedule(Core::Time::Now().Add(blinkInfo.durationInMs), m_blinkTimer);
+                    m_blinkTimer = Utils::TimerWheel::instance().schedule(blinkInfo.durationInMs, [this]() { onBlinkTimer(); });
             }
 
             //if not blink again then the led color should stay on the LAST element in the array as stated in the spec
@@ -754,14 +756,6 @@ namespace WPEFramework
 #endif
         }
 
-        uint64_t BlinkInfo::Timed(const uint64_t scheduledTime)
-        {
-
-            uint64_t result = 0;
-            m_frontPanel->onBlinkTimer();
-            return(result);
-        }
-
     }
 }
 
@@ -34,6 +34,8 @@
 
 #include <plugins/plugins.h>
 
+#include "timerwheel.h"
+
 namespace WPEFramework
 {
 
@@ -44,36 +46,6 @@ namespace WPEFramework
         class FrontPanelHelper;
         class CFrontPanel;
 
-        class BlinkInfo
-        {
-        private:
-            BlinkInfo() = delete;
-            BlinkInfo& operator=(const BlinkInfo& RHS) = delete;
-
-        public:
-            BlinkInfo(CFrontPanel* fp)
-            : m_frontPanel(fp)
-            {
-            }
-            BlinkInfo(const BlinkInfo& copy)
-            : m_frontPanel(copy.m_frontPanel)
-            {
-            }
-            ~BlinkInfo() {}
-
-            inline bool operator==(const BlinkInfo& RHS) const
-            {
-                return(m_frontPanel == RHS.m_frontPanel);
-            }
-
-        public:
-            uint64_t Timed(const uint64_t scheduledTime);
-
-        private:
-            CFrontPanel* m_frontPanel;
-        };
-
-
         typedef struct _FrontPanelBlinkInfo
         {
             std::string ledIndicator;
@@ -135,7 +107,7 @@ namespace WPEFramework
             void setBlinkLed(FrontPanelBlinkInfo blinkInfo);
             JsonObject m_preferencesHash;  // is this needed
 
-            BlinkInfo m_blinkTimer;
+            Utils::TimerWheel::TimerId m_blinkTimer;
             bool m_isBlinking;
             std::vector<FrontPanelBlinkInfo> m_blinkList;
             std::list<FrontPanel*> observers_;
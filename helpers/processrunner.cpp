@@ -0,0 +1,317 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2019 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "processrunner.h"
+
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "utils.h"
+
+#define PROCESS_RUNNER_DEFAULT_CONCURRENCY 4
+#define PROCESS_RUNNER_READ_SIZE 4096
+
+extern char **environ;
+
+namespace Utils
+{
+namespace
+{
+    std::mutex gRunnerMutex;
+    std::condition_variable gRunnerCondition;
+    uint32_t gRunning = 0;
+    uint32_t gConcurrencyLimit = PROCESS_RUNNER_DEFAULT_CONCURRENCY;
+
+    // holds one of the concurrencyLimit() slots for the lifetime of a run, unless the run is not limited
+    class RunnerSlot
+    {
+    public:
+        explicit RunnerSlot(bool limited)
+            : mLimited(limited)
+        {
+            if (!mLimited)
+            {
+                return;
+            }
+            std::unique_lock<std::mutex> lock(gRunnerMutex);
+            gRunnerCondition.wait(lock, []() { return gRunning < gConcurrencyLimit; });
+            gRunning++;
+        }
+
+        ~RunnerSlot()
+        {
+            if (!mLimited)
+            {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(gRunnerMutex);
+            gRunning--;
+            gRunnerCondition.notify_one();
+        }
+
+    private:
+        bool mLimited;
+    };
+
+    int64_t nowMs()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void closePipe(int fds[2])
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            if (fds[i] >= 0)
+            {
+                close(fds[i]);
+                fds[i] = -1;
+            }
+        }
+    }
+
+    pid_t spawn(const std::vector<std::string>& argv, int stdoutPipe[2], int stderrPipe[2], bool mergeStderr)
+    {
+        std::vector<char*> args;
+        for (size_t i = 0; i < argv.size(); i++)
+        {
+            args.push_back(const_cast<char*>(argv[i].c_str()));
+        }
+        args.push_back(nullptr);
+
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+        posix_spawn_file_actions_adddup2(&actions, stdoutPipe[1], STDOUT_FILENO);
+        posix_spawn_file_actions_adddup2(&actions, mergeStderr ? stdoutPipe[1] : stderrPipe[1], STDERR_FILENO);
+
+        // the child starts with default signal handling and its own process group
+        posix_spawnattr_t attributes;
+        posix_spawnattr_init(&attributes);
+        sigset_t signals;
+        sigemptyset(&signals);
+        posix_spawnattr_setsigmask(&attributes, &signals);
+        sigfillset(&signals);
+        sigdelset(&signals, SIGKILL);
+        sigdelset(&signals, SIGSTOP);
+        posix_spawnattr_setsigdefault(&attributes, &signals);
+        posix_spawnattr_setpgroup(&attributes, 0);
+        posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETPGROUP);
+
+        pid_t pid = -1;
+        int status = posix_spawnp(&pid, args[0], &actions, &attributes, args.data(), environ);
+
+        posix_spawnattr_destroy(&attributes);
+        posix_spawn_file_actions_destroy(&actions);
+
+        if (status != 0)
+        {
+            LOGERR("unable to start %s: %s", argv[0].c_str(), strerror(status));
+            return -1;
+        }
+        return pid;
+    }
+} // namespace
+
+ProcessRunner::Result ProcessRunner::run(const std::vector<std::string>& argv, const Options& options)
+{
+    Result result;
+    if (argv.empty())
+    {
+        return result;
+    }
+
+    RunnerSlot slot(options.limitConcurrency);
+
+    int stdoutPipe[2] = { -1, -1 };
+    int stderrPipe[2] = { -1, -1 };
+    if (pipe2(stdoutPipe, O_CLOEXEC) != 0 || (!options.mergeStderr && pipe2(stderrPipe, O_CLOEXEC) != 0))
+    {
+        LOGERR("unable to create pipes for %s: %s", argv[0].c_str(), strerror(errno));
+        closePipe(stdoutPipe);
+        closePipe(stderrPipe);
+        return result;
+    }
+
+    pid_t pid = spawn(argv, stdoutPipe, stderrPipe, options.mergeStderr);
+    close(stdoutPipe[1]);
+    stdoutPipe[1] = -1;
+    if (stderrPipe[1] >= 0)
+    {
+        close(stderrPipe[1]);
+        stderrPipe[1] = -1;
+    }
+    if (pid < 0)
+    {
+        closePipe(stdoutPipe);
+        closePipe(stderrPipe);
+        return result;
+    }
+    result.started = true;
+
+    const int64_t startTime = nowMs();
+    int64_t termTime = (options.timeoutMs > 0) ? startTime + options.timeoutMs : -1;
+    int64_t killTime = -1;
+    bool killed = false;
+
+    struct pollfd fds[2];
+    fds[0].fd = stdoutPipe[0];
+    fds[0].events = POLLIN;
+    fds[1].fd = stderrPipe[0];
+    fds[1].events = POLLIN;
+    char buffer[PROCESS_RUNNER_READ_SIZE];
+
+    while (fds[0].fd >= 0 || fds[1].fd >= 0)
+    {
+        int waitMs = -1;
+        const int64_t now = nowMs();
+        if (termTime >= 0)
+        {
+            if (now >= termTime)
+            {
+                LOGWARN("%s timed out after %u ms, terminating it", argv[0].c_str(), options.timeoutMs);
+                result.timedOut = true;
+                kill(-pid, SIGTERM);
+                termTime = -1;
+                killTime = now + options.killGraceMs;
+                continue;
+            }
+            waitMs = (int)(termTime - now);
+        }
+        else if (killTime >= 0)
+        {
+            if (now >= killTime)
+            {
+                if (killed)
+                {
+                    // something outside the process group still holds the pipes open
+                    break;
+                }
+                LOGWARN("%s did not terminate, killing it", argv[0].c_str());
+                kill(-pid, SIGKILL);
+                killed = true;
+                killTime = now + options.killGraceMs;
+                continue;
+            }
+            waitMs = (int)(killTime - now);
+        }
+
+        int ready = poll(fds, 2, waitMs);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            LOGERR("poll failed for %s: %s", argv[0].c_str(), strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < 2; i++)
+        {
+            if (fds[i].fd < 0 || fds[i].revents == 0)
+            {
+                continue;
+            }
+            ssize_t length = read(fds[i].fd, buffer, sizeof(buffer));
+            if (length > 0)
+            {
+                const OutputCallback& callback = (i == 0) ? options.onStdout : options.onStderr;
+                if (callback)
+                {
+                    callback(buffer, length);
+                }
+                if (options.captureOutput)
+                {
+                    ((i == 0) ? result.output : result.errors).append(buffer, length);
+                }
+            }
+            else if (length == 0 || errno != EINTR)
+            {
+                fds[i].fd = -1;
+            }
+        }
+    }
+
+    closePipe(stdoutPipe);
+    closePipe(stderrPipe);
+
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0)
+    {
+        if (errno != EINTR)
+        {
+            LOGERR("waitpid failed for %s: %s", argv[0].c_str(), strerror(errno));
+            return result;
+        }
+    }
+    if (WIFEXITED(status))
+    {
+        result.exitCode = WEXITSTATUS(status);
+    }
+    else if (WIFSIGNALED(status))
+    {
+        result.signal = WTERMSIG(status);
+    }
+    return result;
+}
+
+void ProcessRunner::runAsync(const std::vector<std::string>& argv, const Options& options, CompletionCallback onComplete)
+{
+    std::thread([argv, options, onComplete]() {
+        Result result = run(argv, options);
+        if (onComplete)
+        {
+            onComplete(result);
+        }
+    }).detach();
+}
+
+ProcessRunner::Result ProcessRunner::runShell(const std::string& command, const Options& options)
+{
+    std::vector<std::string> argv;
+    argv.push_back("/bin/sh");
+    argv.push_back("-c");
+    argv.push_back(command);
+    return run(argv, options);
+}
+
+void ProcessRunner::setConcurrencyLimit(uint32_t limit)
+{
+    std::lock_guard<std::mutex> lock(gRunnerMutex);
+    gConcurrencyLimit = (limit > 0) ? limit : 1;
+    gRunnerCondition.notify_all();
+}
+
+uint32_t ProcessRunner::concurrencyLimit()
+{
+    std::lock_guard<std::mutex> lock(gRunnerMutex);
+    return gConcurrencyLimit;
+}
+} // namespace Utils
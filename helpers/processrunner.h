@@ -0,0 +1,116 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2019 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#ifndef RDKSERVICES_PROCESSRUNNER_H
+#define RDKSERVICES_PROCESSRUNNER_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <stdint.h>
+
+namespace Utils
+{
+    /**
+     * Runs external programs with posix_spawn, without a shell and without forking a copy of the calling process.
+     * The program is looked up in PATH and runs in its own process group, so that a timeout also stops
+     * everything it started. At most concurrencyLimit() programs run at the same time, further calls wait
+     * unless they set Options::limitConcurrency to false.
+     */
+    class ProcessRunner
+    {
+    public:
+        typedef std::function<void(const char* data, size_t length)> OutputCallback;
+
+        struct Options
+        {
+            Options()
+                : timeoutMs(0)
+                , killGraceMs(2000)
+                , captureOutput(true)
+                , mergeStderr(false)
+                , limitConcurrency(true)
+            {
+            }
+
+            // 0 waits forever, otherwise the process group gets SIGTERM and killGraceMs later SIGKILL
+            uint32_t timeoutMs;
+            uint32_t killGraceMs;
+            // collect stdout (and stderr with mergeStderr) into Result::output
+            bool captureOutput;
+            // stderr is sent to the stdout pipe, like "2>&1"
+            bool mergeStderr;
+            // false runs the program right away, for callers that cannot wait behind other runs
+            bool limitConcurrency;
+            // called from the runner with every chunk read from the pipes
+            OutputCallback onStdout;
+            OutputCallback onStderr;
+        };
+
+        struct Result
+        {
+            Result()
+                : started(false)
+                , timedOut(false)
+                , exitCode(-1)
+                , signal(0)
+            {
+            }
+
+            bool started;
+            bool timedOut;
+            // -1 when the program could not be started or was terminated by a signal
+            int exitCode;
+            int signal;
+            std::string output;
+            std::string errors;
+        };
+
+        typedef std::function<void(const Result& result)> CompletionCallback;
+
+        /***
+         * @brief	: Runs a program and waits for it to finish
+         * @param1[in]	: argv, argv[0] is the program name
+         * @param2[in]	: options
+         * @return		: Result; exit status and collected output.
+         */
+        static Result run(const std::vector<std::string>& argv, const Options& options = Options());
+
+        /***
+         * @brief	: Runs a program on a separate thread and calls onComplete from that thread when it finished
+         * @param1[in]	: argv, argv[0] is the program name
+         * @param2[in]	: options
+         * @param3[in]	: completion callback, may be empty
+         */
+        static void runAsync(const std::vector<std::string>& argv, const Options& options, CompletionCallback onComplete);
+
+        /***
+         * @brief	: Runs a shell command line through /bin/sh -c, for callers that need redirection or pipes
+         * @param1[in]	: command line
+         * @param2[in]	: options
+         * @return		: Result; exit status and collected output.
+         */
+        static Result runShell(const std::string& command, const Options& options = Options());
+
+        static void setConcurrencyLimit(uint32_t limit);
+        static uint32_t concurrencyLimit();
+    };
+} // namespace Utils
+
+#endif //RDKSERVICES_PROCESSRUNNER_H
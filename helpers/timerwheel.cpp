@@ -0,0 +1,465 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2019 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "timerwheel.h"
+
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <unordered_map>
+#include <condition_variable>
+#include <string.h>
+
+#include "utils.h"
+
+// level 0 resolves single ticks, every further level covers 64 slots of the level below
+#define TIMER_WHEEL_ROOT_BITS 8
+#define TIMER_WHEEL_LEVEL_BITS 6
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_WHEEL_ROOT_SIZE (1 << TIMER_WHEEL_ROOT_BITS)
+#define TIMER_WHEEL_LEVEL_SIZE (1 << TIMER_WHEEL_LEVEL_BITS)
+#define TIMER_WHEEL_NONE UINT64_MAX
+
+namespace Utils
+{
+namespace
+{
+    struct Timer
+    {
+        TimerWheel::TimerId id;
+        // deadline as requested and deadline after applying the slack, in ticks
+        uint64_t due;
+        uint64_t expires;
+        uint32_t period;
+        uint32_t slack;
+        TimerWheel::Callback callback;
+        // slot list this timer is linked into, nullptr while it is due or running
+        Timer** head;
+        Timer* prev;
+        Timer* next;
+    };
+
+    // rounds the deadline up within the slack so that it has as many trailing zero bits as possible,
+    // timers with close deadlines and enough slack then end up on the same tick
+    uint64_t applySlack(uint64_t due, uint32_t slack)
+    {
+        if (slack == 0)
+        {
+            return due;
+        }
+        uint64_t limit = due + slack;
+        uint64_t mask = limit ^ due;
+        int bit = 63 - __builtin_clzll(mask);
+        mask = (1ULL << bit) - 1;
+        return limit & ~mask;
+    }
+} // namespace
+
+struct TimerWheel::Impl
+{
+    Impl()
+        : base(std::chrono::steady_clock::now())
+        , current(0)
+        , wakeAt(TIMER_WHEEL_NONE)
+        , lastId(0)
+        , runningId(0)
+        , runningCancelled(false)
+        , started(false)
+        , stopping(false)
+    {
+        memset(root, 0, sizeof(root));
+        memset(levels, 0, sizeof(levels));
+    }
+
+    uint64_t now() const
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - base).count();
+    }
+
+    void link(Timer* timer)
+    {
+        uint64_t expires = (timer->expires < current) ? current : timer->expires;
+        uint64_t delta = expires - current;
+        Timer** head = nullptr;
+        if (delta < TIMER_WHEEL_ROOT_SIZE)
+        {
+            head = &root[expires & (TIMER_WHEEL_ROOT_SIZE - 1)];
+        }
+        else
+        {
+            for (int level = 0; level < TIMER_WHEEL_LEVELS && head == nullptr; level++)
+            {
+                int shift = TIMER_WHEEL_ROOT_BITS + level * TIMER_WHEEL_LEVEL_BITS;
+                if (delta < (1ULL << (shift + TIMER_WHEEL_LEVEL_BITS)))
+                {
+                    head = &levels[level][(expires >> shift) & (TIMER_WHEEL_LEVEL_SIZE - 1)];
+                }
+            }
+            if (head == nullptr)
+            {
+                // beyond the outermost level (~49 days), park it in the furthest slot and place it again from there
+                int shift = TIMER_WHEEL_ROOT_BITS + (TIMER_WHEEL_LEVELS - 1) * TIMER_WHEEL_LEVEL_BITS;
+                expires = current + (1ULL << (shift + TIMER_WHEEL_LEVEL_BITS)) - 1;
+                head = &levels[TIMER_WHEEL_LEVELS - 1][(expires >> shift) & (TIMER_WHEEL_LEVEL_SIZE - 1)];
+            }
+        }
+
+        timer->head = head;
+        timer->prev = nullptr;
+        timer->next = *head;
+        if (*head != nullptr)
+        {
+            (*head)->prev = timer;
+        }
+        *head = timer;
+    }
+
+    void unlink(Timer* timer)
+    {
+        if (timer->head == nullptr)
+        {
+            return;
+        }
+        if (timer->prev != nullptr)
+        {
+            timer->prev->next = timer->next;
+        }
+        else
+        {
+            *timer->head = timer->next;
+        }
+        if (timer->next != nullptr)
+        {
+            timer->next->prev = timer->prev;
+        }
+        timer->head = nullptr;
+        timer->prev = nullptr;
+        timer->next = nullptr;
+    }
+
+    // first tick at or after current on which a slot has to be expired or cascaded
+    uint64_t nextEvent() const
+    {
+        if (timers.empty())
+        {
+            return TIMER_WHEEL_NONE;
+        }
+
+        uint64_t next = TIMER_WHEEL_NONE;
+        for (uint64_t i = 0; i < TIMER_WHEEL_ROOT_SIZE; i++)
+        {
+            if (root[(current + i) & (TIMER_WHEEL_ROOT_SIZE - 1)] != nullptr)
+            {
+                next = current + i;
+                break;
+            }
+        }
+
+        for (int level = 0; level < TIMER_WHEEL_LEVELS; level++)
+        {
+            int shift = TIMER_WHEEL_ROOT_BITS + level * TIMER_WHEEL_LEVEL_BITS;
+            uint64_t position = current >> shift;
+            for (uint64_t i = 0; i <= TIMER_WHEEL_LEVEL_SIZE; i++)
+            {
+                uint64_t tick = (position + i) << shift;
+                if (tick >= next)
+                {
+                    break;
+                }
+                if (tick >= current && levels[level][(position + i) & (TIMER_WHEEL_LEVEL_SIZE - 1)] != nullptr)
+                {
+                    next = tick;
+                    break;
+                }
+            }
+        }
+        return next;
+    }
+
+    void cascade(int level, uint64_t slot)
+    {
+        Timer* timer = levels[level][slot];
+        levels[level][slot] = nullptr;
+        while (timer != nullptr)
+        {
+            Timer* next = timer->next;
+            link(timer);
+            timer = next;
+        }
+    }
+
+    // moves everything due up to and including tick `until` into expired
+    void advance(uint64_t until, std::vector<TimerId>& expired)
+    {
+        while (current <= until)
+        {
+            uint64_t next = nextEvent();
+            if (next > until)
+            {
+                current = until + 1;
+                break;
+            }
+            current = next;
+
+            uint64_t index = current & (TIMER_WHEEL_ROOT_SIZE - 1);
+            if (index == 0)
+            {
+                for (int level = 0; level < TIMER_WHEEL_LEVELS; level++)
+                {
+                    uint64_t slot = (current >> (TIMER_WHEEL_ROOT_BITS + level * TIMER_WHEEL_LEVEL_BITS)) & (TIMER_WHEEL_LEVEL_SIZE - 1);
+                    cascade(level, slot);
+                    if (slot != 0)
+                    {
+                        break;
+                    }
+                }
+            }
+
+            Timer* timer = root[index];
+            while (timer != nullptr)
+            {
+                Timer* next = timer->next;
+                if (timer->expires <= current)
+                {
+                    unlink(timer);
+                    expired.push_back(timer->id);
+                }
+                else
+                {
+                    // parked beyond the outermost level
+                    unlink(timer);
+                    link(timer);
+                }
+                timer = next;
+            }
+            current++;
+        }
+    }
+
+    void fire(std::unique_lock<std::mutex>& lock, TimerId id)
+    {
+        auto it = timers.find(id);
+        if (it == timers.end())
+        {
+            // cancelled after it became due
+            return;
+        }
+        Timer* timer = it->second;
+        runningId = id;
+        runningCancelled = false;
+
+        lock.unlock();
+        try
+        {
+            timer->callback();
+        }
+        catch (...)
+        {
+            LOGERR("timer %llu callback threw an exception", (unsigned long long)id);
+        }
+        lock.lock();
+
+        if (runningCancelled)
+        {
+            // cancel() already removed it from timers
+            delete timer;
+        }
+        else if (timer->period > 0)
+        {
+            uint64_t tick = now();
+            timer->due += timer->period;
+            if (timer->due <= tick)
+            {
+                // fell behind, skip the missed periods instead of firing them back to back
+                timer->due = tick + timer->period;
+            }
+            timer->expires = applySlack(timer->due, timer->slack);
+            link(timer);
+        }
+        else
+        {
+            timers.erase(id);
+            delete timer;
+        }
+        runningId = 0;
+        runningCancelled = false;
+        callbackDone.notify_all();
+    }
+
+    void run()
+    {
+        std::vector<TimerId> expired;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping)
+        {
+            advance(now(), expired);
+            if (!expired.empty())
+            {
+                wakeAt = 0;
+                for (size_t i = 0; i < expired.size() && !stopping; i++)
+                {
+                    fire(lock, expired[i]);
+                }
+                expired.clear();
+                continue;
+            }
+
+            wakeAt = nextEvent();
+            if (wakeAt == TIMER_WHEEL_NONE)
+            {
+                condition.wait(lock);
+            }
+            else
+            {
+                condition.wait_until(lock, base + std::chrono::milliseconds(wakeAt));
+            }
+        }
+    }
+
+    const std::chrono::steady_clock::time_point base;
+    // next tick to process
+    uint64_t current;
+    // tick the thread sleeps until, 0 while it is running callbacks
+    uint64_t wakeAt;
+    Timer* root[TIMER_WHEEL_ROOT_SIZE];
+    Timer* levels[TIMER_WHEEL_LEVELS][TIMER_WHEEL_LEVEL_SIZE];
+    std::unordered_map<TimerId, Timer*> timers;
+    TimerId lastId;
+    TimerId runningId;
+    bool runningCancelled;
+    bool started;
+    bool stopping;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::condition_variable callbackDone;
+    std::thread thread;
+};
+
+TimerWheel& TimerWheel::instance()
+{
+    static TimerWheel wheel;
+    return wheel;
+}
+
+TimerWheel::TimerWheel()
+    : mImpl(new Impl())
+{
+}
+
+TimerWheel::~TimerWheel()
+{
+    {
+        std::lock_guard<std::mutex> lock(mImpl->mutex);
+        mImpl->stopping = true;
+        mImpl->condition.notify_all();
+    }
+    if (mImpl->thread.joinable())
+    {
+        if (mImpl->thread.get_id() == std::this_thread::get_id())
+        {
+            // exit() called from a timer callback, the thread cannot join itself and the state has to stay around
+            mImpl->thread.detach();
+            return;
+        }
+        mImpl->thread.join();
+    }
+    for (auto it = mImpl->timers.begin(); it != mImpl->timers.end(); ++it)
+    {
+        delete it->second;
+    }
+    delete mImpl;
+}
+
+TimerWheel::TimerId TimerWheel::schedule(uint32_t delayMs, Callback callback, uint32_t periodMs, uint32_t slackMs)
+{
+    if (!callback)
+    {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(mImpl->mutex);
+    if (mImpl->stopping)
+    {
+        return 0;
+    }
+
+    Timer* timer = new Timer();
+    timer->id = ++mImpl->lastId;
+    timer->due = mImpl->now() + delayMs;
+    timer->expires = applySlack(timer->due, slackMs);
+    timer->period = periodMs;
+    timer->slack = slackMs;
+    timer->callback = std::move(callback);
+    timer->head = nullptr;
+    timer->prev = nullptr;
+    timer->next = nullptr;
+    mImpl->link(timer);
+    mImpl->timers[timer->id] = timer;
+
+    if (!mImpl->started)
+    {
+        mImpl->started = true;
+        mImpl->thread = std::thread([this]() { mImpl->run(); });
+    }
+    else if (timer->expires < mImpl->wakeAt)
+    {
+        mImpl->condition.notify_one();
+    }
+    return timer->id;
+}
+
+bool TimerWheel::cancel(TimerId id)
+{
+    std::unique_lock<std::mutex> lock(mImpl->mutex);
+    if (mImpl->runningId == id && std::this_thread::get_id() != mImpl->thread.get_id())
+    {
+        mImpl->callbackDone.wait(lock, [this, id]() { return mImpl->runningId != id; });
+    }
+
+    auto it = mImpl->timers.find(id);
+    if (it == mImpl->timers.end())
+    {
+        return false;
+    }
+    Timer* timer = it->second;
+    mImpl->timers.erase(it);
+    if (mImpl->runningId == id)
+    {
+        // cancelled from its own callback, fire() deletes it once the callback returned
+        mImpl->runningCancelled = true;
+        return true;
+    }
+    mImpl->unlink(timer);
+    delete timer;
+    return true;
+}
+
+bool TimerWheel::isScheduled(TimerId id)
+{
+    std::lock_guard<std::mutex> lock(mImpl->mutex);
+    auto it = mImpl->timers.find(id);
+    if (it == mImpl->timers.end())
+    {
+        return false;
+    }
+    // a one-shot timer whose callback is running does not fire again
+    return (it->first != mImpl->runningId) || (it->second->period > 0);
+}
+} // namespace Utils
@@ -0,0 +1,79 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2019 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#ifndef RDKSERVICES_TIMERWHEEL_H
+#define RDKSERVICES_TIMERWHEEL_H
+
+#include <functional>
+#include <stdint.h>
+
+namespace Utils
+{
+    /**
+     * One timer thread for all the helpers of a plugin, running on steady_clock with a 1 ms tick.
+     * Timers are kept in a hierarchical wheel (256 slots for the next 256 ms, then four levels of 64 slots),
+     * so scheduling and cancelling are O(1) and the thread only wakes up when something is due.
+     * Callbacks run on the timer thread and should not block it.
+     */
+    class TimerWheel
+    {
+    public:
+        typedef uint64_t TimerId;
+        typedef std::function<void()> Callback;
+
+        static TimerWheel& instance();
+
+        /***
+         * @brief	: Schedules a callback
+         * @param1[in]	: delay before the first call in ms
+         * @param2[in]	: callback
+         * @param3[in]	: period in ms for a periodic timer, 0 for a one-shot timer
+         * @param4[in]	: slack in ms the call may be delayed by, so that timers with nearby deadlines fire together
+         * @return		: TimerId; 0 if the callback is empty.
+         */
+        TimerId schedule(uint32_t delayMs, Callback callback, uint32_t periodMs = 0, uint32_t slackMs = 0);
+
+        /***
+         * @brief	: Cancels a timer. If its callback is running on the timer thread, waits for it to return,
+         *		  unless called from that callback.
+         * @param1[in]	: timer id
+         * @return		: true if the timer was still scheduled.
+         */
+        bool cancel(TimerId id);
+
+        /***
+         * @brief	: Checks whether a timer is going to fire (again)
+         * @param1[in]	: timer id
+         * @return		: false for cancelled timers and for one-shot timers that fired or are firing.
+         */
+        bool isScheduled(TimerId id);
+
+        ~TimerWheel();
+
+    private:
+        TimerWheel();
+        TimerWheel(const TimerWheel&) = delete;
+        TimerWheel& operator=(const TimerWheel&) = delete;
+
+        struct Impl;
+        Impl* mImpl;
+    };
+} // namespace Utils
+
+#endif //RDKSERVICES_TIMERWHEEL_H
@@ -19,18 +19,22 @@
 
 #include "tptimer.h"
 
+#include <algorithm>
+
 namespace WPEFramework
 {
 
     namespace Plugin
     {    
         TpTimer::TpTimer() :
-                baseTimer(64 * 1024, "ThunderPluginBaseTimer")
-                , m_timerJob(this)
+                m_timerId(0)
         , m_isActive(false)
         , m_isSingleShot(false)
         , m_intervalInMs(-1)
-        {}
+        {
+            // construct the wheel first so that it outlives static timers
+            Utils::TimerWheel::instance();
+        }
 
         TpTimer::~TpTimer()
         {
@@ -44,15 +48,20 @@ namespace WPEFramework
 
         void TpTimer::stop()
         {
-            baseTimer.Revoke(m_timerJob);
+            Utils::TimerWheel::TimerId timerId = m_timerId.exchange(0);
+            if (timerId != 0) {
+                Utils::TimerWheel::instance().cancel(timerId);
+            }
             m_isActive = false;
         }
         
         void TpTimer::start()
         {
-            baseTimer.Revoke(m_timerJob);
-            baseTimer.Schedule(Core::Time::Now().Add(m_intervalInMs), m_timerJob);
+            stop();
+            uint32_t interval = (m_intervalInMs > 0) ? m_intervalInMs : 0;
+            uint32_t period = m_isSingleShot ? 0 : std::max<uint32_t>(interval, 1);
             m_isActive = true;
+            m_timerId = Utils::TimerWheel::instance().schedule(interval, [this]() { Timed(); }, period);
         }
 
         void TpTimer::start(int msec)
@@ -82,21 +91,10 @@ namespace WPEFramework
                 onTimeoutCallback();
             }
             
-            if (m_isActive) {
-                if(m_isSingleShot) {
-                    stop();
-                } else{
-                start();
-                }
-            }
-        }
-        
-        uint64_t TpTimerJob::Timed(const uint64_t scheduledTime)
-        {
-            if(m_tptimer) {
-                m_tptimer->Timed();
+            // the wheel already dropped a single shot timer, unless the callback restarted it
+            if (m_isActive && m_isSingleShot && !Utils::TimerWheel::instance().isScheduled(m_timerId)) {
+                m_isActive = false;
             }
-            return 0;
         }
     }
 }
@@ -23,36 +23,15 @@
 //#include <core/Timer.h>
 #include <plugins/plugins.h>
 
+#include <atomic>
+
+#include "timerwheel.h"
+
 namespace WPEFramework
 {
 
     namespace Plugin
     {
-        class TpTimer;
-        
-        class TpTimerJob
-        {
-        private:
-            TpTimerJob() = delete;
-            TpTimerJob& operator=(const TpTimerJob& RHS) = delete;
-
-        public:
-            TpTimerJob(WPEFramework::Plugin::TpTimer* tpt) : m_tptimer(tpt) { }
-            TpTimerJob(const TpTimerJob& copy) : m_tptimer(copy.m_tptimer) { }
-            ~TpTimerJob() {}
-
-            inline bool operator==(const TpTimerJob& RHS) const
-            {
-                return(m_tptimer == RHS.m_tptimer);
-            }
-
-        public:
-            uint64_t Timed(const uint64_t scheduledTime);
-
-        private:
-            WPEFramework::Plugin::TpTimer* m_tptimer;
-        };
-
         class TpTimer
         {
         public:
@@ -72,15 +51,13 @@ namespace WPEFramework
             
             void Timed();
             
-            WPEFramework::Core::TimerType<TpTimerJob> baseTimer;
-            TpTimerJob m_timerJob;
-            bool m_isActive;
+            // written by start()/stop() and read from the timer thread
+            std::atomic<Utils::TimerWheel::TimerId> m_timerId;
+            std::atomic<bool> m_isActive;
             bool m_isSingleShot;
             int m_intervalInMs;
             
             std::function< void() > onTimeoutCallback;
-            
-            friend class TpTimerJob;
         };
     }
     
@@ -25,12 +25,20 @@
 #include <string.h>
 #include <sstream>
 #include "utils.h"
+#include "processrunner.h"
 #include "libIBus.h"
 #include <securityagent/SecurityTokenUtil.h>
 #include <curl/curl.h>
 #include <utility>
 #include <ctype.h>
 #include <mutex>
+#include <atomic>
+#include <map>
+#include <chrono>
+#include <condition_variable>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #define MAX_STRING_LENGTH 2048
 
@@ -102,21 +110,16 @@ std::string Utils::formatIARMResult(IARM_Result_t result)
  */
 std::string Utils::cRunScript(const char *cmd)
 {
-    std::string totalStr = "";
-    FILE *pipe = NULL;
-    char buff[1024] = {'\0'};
-
-    if ((pipe = popen(cmd, "r"))) {
-        memset(buff, 0, sizeof(buff));
-        while (fgets(buff, sizeof(buff), pipe)) {
-            totalStr += buff;
-            memset(buff, 0, sizeof(buff));
-        }
-        pclose(pipe);
-    } else {
-        /* popen failed. */
+    // spawned through /bin/sh instead of popen so that the plugin process is not forked. like popen it has
+    // no timeout and does not wait for the runner's concurrency limit, which other callers may be holding
+    ProcessRunner::Options options;
+    options.limitConcurrency = false;
+    ProcessRunner::Result result = ProcessRunner::runShell(cmd, options);
+    if (!result.errors.empty())
+    {
+        LOGWARN("%s: %s", cmd, result.errors.c_str());
     }
-    return totalStr;
+    return result.output;
 }
 
 using namespace WPEFramework;
@@ -260,15 +263,223 @@ bool Utils::SecurityToken::isThunderSecurityConfigured()
 }
 
 // Thunder plugins communication
+namespace {
+    typedef WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> ThunderClient;
+
+    struct ThunderClientEntry {
+        std::shared_ptr<ThunderClient> client;
+        bool failed;
+        std::chrono::steady_clock::time_point failedTime;
+
+        ThunderClientEntry() : failed(false) {}
+    };
+
+    // target of in-process calls, dropped again as soon as the plugin is no longer activated
+    struct ThunderDirectTarget {
+        PluginHost::IShell* shell;
+        PluginHost::IDispatcher* dispatcher;
+        string designator;
+    };
+
+    // links to other plugins shared by all users of Utils::getThunderControllerClient and Utils::ThunderLink
+    // in this plugin library
+    class ThunderLinkPool {
+    public:
+        static ThunderLinkPool& instance()
+        {
+            static ThunderLinkPool pool;
+            return pool;
+        }
+
+        std::shared_ptr<ThunderClient> client(const string& callsign)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            ThunderClientEntry& entry = mClients[callsign];
+            if (entry.client && (!entry.failed ||
+                std::chrono::steady_clock::now() - entry.failedTime < std::chrono::milliseconds(THUNDER_CLIENT_RECONNECT_INTERVAL_MS))) {
+                return entry.client;
+            }
+
+            if (entry.client) {
+                LOGWARN("reconnecting the link to '%s'", callsign.c_str());
+            }
+            string token;
+            Utils::SecurityToken::getSecurityToken(token);
+            string query = "token=" + token;
+            Core::SystemInfo::SetEnvironment(_T("THUNDER_ACCESS"), (_T(SERVER_DETAILS)));
+            entry.client = std::make_shared<ThunderClient>(callsign.c_str(), "", false, query);
+            entry.failed = false;
+            return entry.client;
+        }
+
+        void status(const string& callsign, uint32_t status)
+        {
+            // only errors of the link itself, not of the called method
+            if (status != Core::ERROR_TIMEDOUT && status != Core::ERROR_ASYNC_FAILED &&
+                status != Core::ERROR_CONNECTION_CLOSED && status != Core::ERROR_UNAVAILABLE) {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(mMutex);
+            auto it = mClients.find(callsign);
+            if (it != mClients.end() && !it->second.failed) {
+                LOGWARN("link to '%s' failed with %u", callsign.c_str(), status);
+                it->second.failed = true;
+                it->second.failedTime = std::chrono::steady_clock::now();
+            }
+        }
+
+        void setService(PluginHost::IShell* service)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            for (auto it = mTargets.begin(); it != mTargets.end(); it++) {
+                release(it->second);
+            }
+            mTargets.clear();
+            mService = service;
+        }
+
+        bool invoke(const string& callsign, const string& method, const string& parameters, string& result, uint32_t& status)
+        {
+            PluginHost::IDispatcher* dispatcher = nullptr;
+            string designator;
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (mService == nullptr) {
+                    return false;
+                }
+                ThunderDirectTarget* target = find(callsign);
+                if (target == nullptr) {
+                    return false;
+                }
+                // the reference keeps the dispatcher alive while the call runs outside of the lock
+                dispatcher = target->dispatcher;
+                dispatcher->AddRef();
+                designator = target->designator;
+            }
+
+            Core::ProxyType<Core::JSONRPC::Message> message(PluginHost::IFactories::Instance().JSONRPC());
+            message->JSONRPC = Core::JSONRPC::Message::DefaultVersion;
+            message->Id = Core::JSON::DecUInt32(++mLastId);
+            message->Designator = Core::JSON::String(designator + method);
+            if (!parameters.empty()) {
+                message->Parameters = parameters;
+            }
+
+            string token;
+            Utils::SecurityToken::getSecurityToken(token);
+            Core::ProxyType<Core::JSONRPC::Message> response = dispatcher->Invoke(token, ~0, *message);
+            dispatcher->Release();
+
+            if (!response.IsValid()) {
+                // asynchronous methods answer on a channel, which a direct call does not have
+                LOGERR("%s%s did not respond synchronously", designator.c_str(), method.c_str());
+                status = Core::ERROR_ASYNC_FAILED;
+            } else if (response->Error.IsSet()) {
+                status = response->Error.Code.Value();
+            } else {
+                result = response->Result.Value();
+                status = Core::ERROR_NONE;
+            }
+            return true;
+        }
+
+    private:
+        ThunderLinkPool() : mService(nullptr), mLastId(0) {}
+
+        ~ThunderLinkPool()
+        {
+            for (auto it = mTargets.begin(); it != mTargets.end(); it++) {
+                release(it->second);
+            }
+        }
+
+        static void release(ThunderDirectTarget& target)
+        {
+            if (target.dispatcher != nullptr) {
+                target.dispatcher->Release();
+            }
+            if (target.shell != nullptr) {
+                target.shell->Release();
+            }
+            target.dispatcher = nullptr;
+            target.shell = nullptr;
+        }
+
+        // health check on every call: a target that is not activated is released and queried again next time
+        ThunderDirectTarget* find(const string& callsign)
+        {
+            auto it = mTargets.find(callsign);
+            if (it != mTargets.end()) {
+                if (it->second.shell->State() == PluginHost::IShell::ACTIVATED) {
+                    return &it->second;
+                }
+                release(it->second);
+                mTargets.erase(it);
+            }
+
+            // "org.rdk.System.1" is the callsign "org.rdk.System" with version 1, an empty callsign is the Controller
+            string name = callsign.empty() ? "Controller" : callsign;
+            string version = "1";
+            size_t dot = name.find_last_of('.');
+            if (dot != string::npos && dot + 1 < name.size() &&
+                name.find_first_not_of("0123456789", dot + 1) == string::npos) {
+                version = name.substr(dot + 1);
+                name = name.substr(0, dot);
+            }
+
+            ThunderDirectTarget target;
+            target.shell = mService->QueryInterfaceByCallsign<PluginHost::IShell>(name);
+            if (target.shell == nullptr || target.shell->State() != PluginHost::IShell::ACTIVATED) {
+                target.dispatcher = nullptr;
+                release(target);
+                return nullptr;
+            }
+            target.dispatcher = mService->QueryInterfaceByCallsign<PluginHost::IDispatcher>(name);
+            if (target.dispatcher == nullptr) {
+                release(target);
+                return nullptr;
+            }
+            target.designator = name + "." + version + ".";
+            return &(mTargets[callsign] = target);
+        }
+
+        std::mutex mMutex;
+        std::map<string, ThunderClientEntry> mClients;
+        std::map<string, ThunderDirectTarget> mTargets;
+        PluginHost::IShell* mService;
+        std::atomic<uint32_t> mLastId;
+    };
+}
+
 std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> > Utils::getThunderControllerClient(std::string callsign)
 {
-    string token;
-    Utils::SecurityToken::getSecurityToken(token);
-    string query = "token=" + token;
+    return ThunderLinkPool::instance().client(callsign);
+}
+
+void Utils::reportThunderClientStatus(const std::string& callsign, uint32_t status)
+{
+    ThunderLinkPool::instance().status(callsign, status);
+}
+
+void Utils::setThunderService(WPEFramework::PluginHost::IShell* service)
+{
+    ThunderLinkPool::instance().setService(service);
+}
+
+bool Utils::ThunderLink::invokeDirect(const std::string& method, const WPEFramework::Core::JSON::IElement& parameters, std::string& result, uint32_t& status)
+{
+    string values;
+    if (parameters.IsSet() && !parameters.ToString(values)) {
+        LOGERR("unable to serialize the parameters of %s", method.c_str());
+        status = Core::ERROR_GENERAL;
+        return true;
+    }
+    return ThunderLinkPool::instance().invoke(mCallsign, method, values, result, status);
+}
 
-    Core::SystemInfo::SetEnvironment(_T("THUNDER_ACCESS"), (_T(SERVER_DETAILS)));
-    static std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> > thunderClient = make_shared<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> >(callsign.c_str(), "",false,query);
-    return thunderClient;
+std::shared_ptr<Utils::ThunderLink> Utils::getThunderLink(const std::string& callsign)
+{
+    return std::make_shared<ThunderLink>(callsign);
 }
 
 void Utils::activatePlugin(const char* callSign)
@@ -280,7 +491,7 @@ void Utils::activatePlugin(const char* callSign)
     if(!isPluginActivated(callSign))
     {
         LOGINFO("Activating %s", callSign);
-        uint32_t status = getThunderControllerClient()->Invoke<JsonObject, JsonObject>(2000, "activate", joParams, joResult);
+        uint32_t status = getThunderLink()->Invoke<JsonObject, JsonObject>(2000, "activate", joParams, joResult);
         string strParams;
         string strResult;
         joParams.ToString(strParams);
@@ -301,7 +512,7 @@ bool Utils::isPluginActivated(const char* callSign)
 {
     string method = "status@" + string(callSign);
     Core::JSON::ArrayType<PluginHost::MetaData::Service> joResult;
-    uint32_t status = getThunderControllerClient()->Get<Core::JSON::ArrayType<PluginHost::MetaData::Service> >(2000, method.c_str(),joResult);
+    uint32_t status = getThunderLink()->Get<Core::JSON::ArrayType<PluginHost::MetaData::Service> >(2000, method.c_str(),joResult);
     bool pluginActivated = false;
     if (status == Core::ERROR_NONE)
     {
@@ -393,27 +604,213 @@ void Utils::syncPersistFile (const string file) {
     fclose(fp);
 }
 
-void Utils::persistJsonSettings(const string strFile, const string strKey, const JsonValue& jsValue)
-{
-    Core::File file;
-    file = strFile.c_str();
+namespace {
+    // json settings files shared by all users of Utils::persistJsonSettings in this plugin library. every file is
+    // read once and then served from memory, updates are coalesced into one atomic write JSON_SETTINGS_WRITE_BEHIND_MS later
+    struct JsonSettingsFile {
+        JsonObject settings;
+        JsonObject pending;
+        bool dirty;
+        struct stat fileStat;
+        std::chrono::steady_clock::time_point writeTime;
+        // delay before the next attempt when writing the file failed
+        uint32_t retryMs;
+
+        JsonSettingsFile() : dirty(false), retryMs(JSON_SETTINGS_WRITE_BEHIND_MS) { memset(&fileStat, 0, sizeof(fileStat)); }
+    };
+
+    bool sameFile(const struct stat& first, const struct stat& second)
+    {
+        return (first.st_ino == second.st_ino) && (first.st_size == second.st_size) &&
+            (first.st_mtime == second.st_mtime) && (first.st_mtim.tv_nsec == second.st_mtim.tv_nsec);
+    }
+
+    class JsonSettingsStore {
+    public:
+        static JsonSettingsStore& instance()
+        {
+            static JsonSettingsStore store;
+            return store;
+        }
+
+        bool load(const string& strFile, JsonObject& settings)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            JsonSettingsFile* entry = find(strFile);
+            settings = entry->settings;
+            return (0 != entry->fileStat.st_ino);
+        }
+
+        void set(const string& strFile, const JsonObject& values)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            JsonSettingsFile* entry = find(strFile);
+            JsonObject::Iterator iterator = values.Variants();
+            while (iterator.Next()) {
+                entry->settings[iterator.Label()] = iterator.Current();
+                entry->pending[iterator.Label()] = iterator.Current();
+            }
+            if (!entry->dirty) {
+                entry->dirty = true;
+                entry->writeTime = std::chrono::steady_clock::now() + std::chrono::milliseconds(JSON_SETTINGS_WRITE_BEHIND_MS);
+            }
+            if (!mWriter.joinable()) {
+                mRunning = true;
+                mWriter = std::thread(&JsonSettingsStore::run, this);
+            }
+            mCondition.notify_one();
+        }
+
+        bool flush()
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            bool status = true;
+            for (auto it = mFiles.begin(); it != mFiles.end(); it++) {
+                if (it->second.dirty && !write(it->first, it->second)) {
+                    status = false;
+                }
+            }
+            return status;
+        }
+
+    private:
+        JsonSettingsStore() : mRunning(false) {}
+
+        ~JsonSettingsStore()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mRunning = false;
+                mCondition.notify_one();
+            }
+            if (mWriter.joinable()) {
+                mWriter.join();
+            }
+            flush();
+        }
 
-    file.Open(false);
-    if (!file.IsOpen())
-        file.Create();
+        // returns the cached file, read again when it was replaced by someone else since it was read or written
+        JsonSettingsFile* find(const string& strFile)
+        {
+            JsonSettingsFile& entry = mFiles[strFile];
+            struct stat fileStat;
+            memset(&fileStat, 0, sizeof(fileStat));
+            stat(strFile.c_str(), &fileStat);
+            if (!sameFile(entry.fileStat, fileStat)) {
+                entry.settings.Clear();
+                std::ifstream file(strFile);
+                if (file) {
+                    std::stringstream content;
+                    content << file.rdbuf();
+                    entry.settings.FromString(content.str());
+                }
+                // updates that were not written yet stay on top of the file
+                JsonObject::Iterator iterator = entry.pending.Variants();
+                while (iterator.Next()) {
+                    entry.settings[iterator.Label()] = iterator.Current();
+                }
+                entry.fileStat = fileStat;
+            }
+            return &entry;
+        }
+
+        // writes a temporary file, syncs it and renames it over the settings file. on failure the updates stay
+        // pending and the writer thread tries again after a growing delay
+        bool write(const string& strFile, JsonSettingsFile& entry)
+        {
+            find(strFile);
+            string content;
+            entry.settings.ToString(content);
+            string tmpFile = strFile + ".tmp";
+            int fd = open(tmpFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fd < 0) {
+                LOGERR("unable to create %s: %s", tmpFile.c_str(), strerror(errno));
+                retryWrite(entry);
+                return false;
+            }
+            size_t written = 0;
+            while (written < content.size()) {
+                ssize_t result = ::write(fd, content.data() + written, content.size() - written);
+                if (result <= 0) {
+                    break;
+                }
+                written += result;
+            }
+            bool status = (written == content.size()) && (0 == fsync(fd));
+            close(fd);
+            if (status && (0 == rename(tmpFile.c_str(), strFile.c_str()))) {
+                stat(strFile.c_str(), &entry.fileStat);
+                entry.pending.Clear();
+                entry.dirty = false;
+                entry.retryMs = JSON_SETTINGS_WRITE_BEHIND_MS;
+            } else {
+                LOGERR("unable to write %s", strFile.c_str());
+                unlink(tmpFile.c_str());
+                retryWrite(entry);
+                status = false;
+            }
+            return status;
+        }
+
+        void retryWrite(JsonSettingsFile& entry)
+        {
+            entry.writeTime = std::chrono::steady_clock::now() + std::chrono::milliseconds(entry.retryMs);
+            entry.retryMs = std::min(entry.retryMs * 2, (uint32_t)JSON_SETTINGS_WRITE_RETRY_MAX_MS);
+        }
+
+        void run()
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            while (mRunning) {
+                bool dirty = false;
+                std::chrono::steady_clock::time_point nextWrite;
+                const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                for (auto it = mFiles.begin(); it != mFiles.end(); it++) {
+                    if (!it->second.dirty) {
+                        continue;
+                    }
+                    if ((it->second.writeTime <= now) && write(it->first, it->second)) {
+                        continue;
+                    }
+                    if (!dirty || it->second.writeTime < nextWrite) {
+                        nextWrite = it->second.writeTime;
+                        dirty = true;
+                    }
+                }
+                if (dirty) {
+                    mCondition.wait_until(lock, nextWrite);
+                } else {
+                    mCondition.wait(lock);
+                }
+            }
+        }
 
-    JsonObject cecSetting;
-    cecSetting.IElement::FromFile(file);
-    file.Destroy();
-    file.Create();
-    cecSetting[strKey.c_str()] = jsValue;
-    cecSetting.IElement::ToFile(file);
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        std::map<string, JsonSettingsFile> mFiles;
+        std::thread mWriter;
+        bool mRunning;
+    };
+}
 
-    file.Close();
+bool Utils::loadJsonSettings(const string strFile, JsonObject& settings)
+{
+    return JsonSettingsStore::instance().load(strFile, settings);
+}
 
-    //Sync the settings
-    Utils::syncPersistFile (strFile);
+void Utils::persistJsonSettings(const string strFile, const string strKey, const JsonValue& jsValue)
+{
+    JsonObject values;
+    values[strKey.c_str()] = jsValue;
+    JsonSettingsStore::instance().set(strFile, values);
+}
 
-    return;
+void Utils::persistJsonSettings(const string strFile, const JsonObject& values)
+{
+    JsonSettingsStore::instance().set(strFile, values);
 }
 
+bool Utils::flushJsonSettings()
+{
+    return JsonSettingsStore::instance().flush();
+}
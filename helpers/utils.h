@@ -26,6 +26,7 @@
 #include <plugins/plugins.h>
 #include <tracing/tracing.h>
 #include "rfcapi.h"
+#include "asynclog.h"
 
 // telemetry
 #ifdef ENABLE_TELEMETRY_LOGGING
@@ -42,13 +43,24 @@
 #define UNUSED(expr)(void)(expr)
 #define C_STR(x) (x).c_str()
 
+#ifdef DISABLE_ASYNC_LOGGING
 #define LOGINFO(fmt, ...) do { fprintf(stderr, "[%d] INFO [%s:%d] %s: " fmt "\n", (int)syscall(SYS_gettid), Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, ##__VA_ARGS__); fflush(stderr); } while (0)
 #define LOGDBG(fmt, ...) do { fprintf(stderr, "[%d] DEBUG [%s:%d] %s: " fmt "\n", (int)syscall(SYS_gettid), Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, ##__VA_ARGS__); fflush(stderr); } while (0)
 #define LOGWARN(fmt, ...) do { fprintf(stderr, "[%d] WARN [%s:%d] %s: " fmt "\n", (int)syscall(SYS_gettid), Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, ##__VA_ARGS__); fflush(stderr); } while (0)
 #define LOGERR(fmt, ...) do { fprintf(stderr, "[%d] ERROR [%s:%d] %s: " fmt "\n", (int)syscall(SYS_gettid), Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, ##__VA_ARGS__); fflush(stderr); Utils::Telemetry::sendError(fmt, ##__VA_ARGS__); } while (0)
+#else
+// lines are queued for a writer thread instead of being written on the calling thread, see asynclog.h
+#define LOGINFO(fmt, ...) do { if (Utils::AsyncLog::isEnabled(Utils::AsyncLog::LEVEL_INFO)) Utils::AsyncLog::write("INFO", Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, fmt, ##__VA_ARGS__); } while (0)
+#define LOGDBG(fmt, ...) do { if (Utils::AsyncLog::isEnabled(Utils::AsyncLog::LEVEL_DEBUG)) Utils::AsyncLog::write("DEBUG", Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, fmt, ##__VA_ARGS__); } while (0)
+#define LOGWARN(fmt, ...) do { if (Utils::AsyncLog::isEnabled(Utils::AsyncLog::LEVEL_WARN)) Utils::AsyncLog::write("WARN", Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, fmt, ##__VA_ARGS__); } while (0)
+#define LOGERR(fmt, ...) do { Utils::AsyncLog::write("ERROR", Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, fmt, ##__VA_ARGS__); Utils::Telemetry::sendError(fmt, ##__VA_ARGS__); } while (0)
+#endif
 
-#define LOGINFOMETHOD() { std::string json; parameters.ToString(json); LOGINFO( "params=%s", json.c_str() );  }
-#define LOGTRACEMETHODFIN() do { std::string json; response.ToString(json); LOGINFO( "response=%s", json.c_str() );  } while (0)
+// request, response and event payloads are only serialized when info is enabled, arrays with more elements
+// than LOG_PAYLOAD_MAX_ARRAY_ITEMS are logged as "[<n> items]", see Utils::logPayload
+#define LOG_PAYLOAD_MAX_ARRAY_ITEMS 16
+#define LOGINFOMETHOD() { if (Utils::AsyncLog::isEnabled(Utils::AsyncLog::LEVEL_INFO)) { std::string json = Utils::logPayload(parameters); LOGINFO( "params=%s", json.c_str() ); } }
+#define LOGTRACEMETHODFIN() do { if (Utils::AsyncLog::isEnabled(Utils::AsyncLog::LEVEL_INFO)) { std::string json = Utils::logPayload(response); LOGINFO( "response=%s", json.c_str() ); } } while (0)
 
 #define LOG_DEVICE_EXCEPTION0() LOGWARN("Exception caught: code=%d message=%s", err.getCode(), err.what());
 #define LOG_DEVICE_EXCEPTION1(param1) LOGWARN("Exception caught" #param1 "=%s code=%d message=%s", param1.c_str(), err.getCode(), err.what());
@@ -116,9 +128,10 @@
     }
 
 #define sendNotify(event,params) { \
-    std::string json; \
-    params.ToString(json); \
-    LOGINFO("Notify %s %s", event, json.c_str()); \
+    if (Utils::AsyncLog::isEnabled(Utils::AsyncLog::LEVEL_INFO)) { \
+        std::string json = Utils::logPayload(params); \
+        LOGINFO("Notify %s %s", event, json.c_str()); \
+    } \
     Notify(event,params); \
 }
 
@@ -329,6 +342,50 @@ namespace Utils
      */
     bool isFileExistsAndOlderThen(const char *pFileName, long age = -1);
 
+    /***
+     * @brief	: Serializes a request, response or event for the log, large top level arrays are summarized
+     * @param1[in]	: object to be logged
+     * @return		: string; json representation.
+     */
+    inline std::string logPayload(const JsonObject& object)
+    {
+        std::string payload = "{";
+        JsonObject::Iterator member = object.Variants();
+        bool first = true;
+        while (member.Next())
+        {
+            if (!first)
+            {
+                payload += ",";
+            }
+            first = false;
+            payload += "\"";
+            payload += member.Label();
+            payload += "\":";
+            const JsonValue& value = member.Current();
+            if (value.Content() == JsonValue::type::ARRAY && value.Array().Length() > LOG_PAYLOAD_MAX_ARRAY_ITEMS)
+            {
+                payload += "[" + std::to_string(value.Array().Length()) + " items]";
+            }
+            else
+            {
+                std::string json;
+                value.ToString(json);
+                payload += json;
+            }
+        }
+        payload += "}";
+        return payload;
+    }
+
+    template<typename JSONELEMENT>
+    std::string logPayload(const JSONELEMENT& element)
+    {
+        std::string json;
+        element.ToString(json);
+        return json;
+    }
+
     struct SecurityToken
     {
         static void getSecurityToken(std::string& token);
@@ -340,7 +397,92 @@ namespace Utils
     };
 
     // Thunder Plugin Communication
+    /***
+     * @brief	: Websocket links are pooled per callsign and created on first use. A link whose call failed with
+     *            a connection error (see reportThunderClientStatus) is replaced by a new one on next use, at most
+     *            once per THUNDER_CLIENT_RECONNECT_INTERVAL_MS.
+     */
+    #define THUNDER_CLIENT_RECONNECT_INTERVAL_MS 2000
     std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement>> getThunderControllerClient(std::string callsign="");
+    void reportThunderClientStatus(const std::string& callsign, uint32_t status);
+
+    /***
+     * @brief	: Registers the shell of the calling plugin so that ThunderLink calls to plugins in the same
+     *            process are dispatched directly. Call it with nullptr from Deinitialize to release the
+     *            interfaces held by the pool.
+     */
+    void setThunderService(WPEFramework::PluginHost::IShell* service);
+
+    /***
+     * @brief	: JSON-RPC link to a plugin, the callsign may carry the version ("org.rdk.System.1") and is
+     *            empty for the Controller. While the target is activated, calls go through its IDispatcher,
+     *            obtained with IShell::QueryInterfaceByCallsign, without a websocket round trip. Otherwise,
+     *            or when no shell was registered with setThunderService, they go over getThunderControllerClient.
+     *            Events are not supported, subscribe on a getThunderControllerClient link.
+     */
+    class ThunderLink
+    {
+    public:
+        explicit ThunderLink(const std::string& callsign) : mCallsign(callsign) {}
+
+        template <typename PARAMETERS, typename RESPONSE>
+        uint32_t Invoke(const uint32_t waitTime, const std::string& method, const PARAMETERS& parameters, RESPONSE& response)
+        {
+            uint32_t status = WPEFramework::Core::ERROR_NONE;
+            std::string result;
+            if (invokeDirect(method, parameters, result, status))
+            {
+                if (status == WPEFramework::Core::ERROR_NONE && !result.empty() && !response.FromString(result))
+                {
+                    status = WPEFramework::Core::ERROR_GENERAL;
+                }
+                return status;
+            }
+            status = getThunderControllerClient(mCallsign)->template Invoke<PARAMETERS, RESPONSE>(waitTime, method, parameters, response);
+            reportThunderClientStatus(mCallsign, status);
+            return status;
+        }
+
+        template <typename RESPONSE>
+        uint32_t Get(const uint32_t waitTime, const std::string& method, RESPONSE& response)
+        {
+            uint32_t status = WPEFramework::Core::ERROR_NONE;
+            std::string result;
+            if (invokeDirect(method, JsonObject(), result, status))
+            {
+                if (status == WPEFramework::Core::ERROR_NONE && !response.FromString(result))
+                {
+                    status = WPEFramework::Core::ERROR_GENERAL;
+                }
+                return status;
+            }
+            status = getThunderControllerClient(mCallsign)->template Get<RESPONSE>(waitTime, method, response);
+            reportThunderClientStatus(mCallsign, status);
+            return status;
+        }
+
+        template <typename PARAMETERS>
+        uint32_t Set(const uint32_t waitTime, const std::string& method, const PARAMETERS& parameters)
+        {
+            uint32_t status = WPEFramework::Core::ERROR_NONE;
+            std::string result;
+            if (invokeDirect(method, parameters, result, status))
+            {
+                return status;
+            }
+            status = getThunderControllerClient(mCallsign)->template Set<PARAMETERS>(waitTime, method, parameters);
+            reportThunderClientStatus(mCallsign, status);
+            return status;
+        }
+
+    private:
+        // false when the call has to go over the websocket link
+        bool invokeDirect(const std::string& method, const WPEFramework::Core::JSON::IElement& parameters, std::string& result, uint32_t& status);
+
+        std::string mCallsign;
+    };
+
+    std::shared_ptr<ThunderLink> getThunderLink(const std::string& callsign = "");
 
     void activatePlugin(const char* callSign);
 
@@ -349,7 +491,20 @@ namespace Utils
     bool getRFCConfig(char* paramName, RFC_ParamData_t& paramOutput);
     bool isValidInt(char* x);
     void syncPersistFile (const string file);
+
+    /***
+     * @brief	: Json settings files are read once per plugin and then served from memory. Updates are
+     *            coalesced for JSON_SETTINGS_WRITE_BEHIND_MS and written to a temporary file that replaces
+     *            the settings file, a file replaced by another process is read again before it is used.
+     *            Updates that fail to be written stay pending and are retried, flushJsonSettings() returns
+     *            false while any file could not be written.
+     */
+    #define JSON_SETTINGS_WRITE_BEHIND_MS 200
+    #define JSON_SETTINGS_WRITE_RETRY_MAX_MS 30000
+    bool loadJsonSettings(const string file, JsonObject& settings);
     void persistJsonSettings(const string file, const string strKey, const JsonValue& jsValue);
+    void persistJsonSettings(const string file, const JsonObject& values);
+    bool flushJsonSettings();
 
     //class for std::thread RAII
     class ThreadRAII 